@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// A function to be called from Wasm code.
+own wasm_trap_t* host_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  results->data[0].kind = WASM_I32;
+  results->data[0].of.i32 = args->data[0].of.i32 * args->data[1].of.i32;
+  return NULL;
+}
+
+
+// Records the outcome of one asynchronous call.
+typedef struct call_t {
+  int called;
+  int trapped;
+  int32_t result;
+} call_t;
+
+void async_callback(
+  void* env, const wasm_val_vec_t* results, const wasm_message_t* trap
+) {
+  call_t* call = (call_t*)env;
+  ++call->called;
+  if (trap) {
+    call->trapped = 1;
+    printf("> Call trapped: %s\n", trap->data);
+  } else if (results && results->size == 1 && results->data[0].kind == WASM_I32) {
+    call->result = results->data[0].of.i32;
+  }
+}
+
+void call_async(
+  wasm_store_t* store, const wasm_func_t* func,
+  wasm_val_t arg1, wasm_val_t arg2, call_t* call
+) {
+  wasm_val_t vals[2] = { arg1, arg2 };
+  own wasm_val_vec_t args;
+  wasm_val_vec_new(&args, 2, vals);
+  memset(call, 0, sizeof(call_t));
+  wasm_func_call_async(store, func, &args, async_callback, call);
+}
+
+void check_result(const char* what, const call_t* call, int32_t expected) {
+  if (call->called != 1 || call->trapped || call->result != expected) {
+    printf("> Error: %s = %" PRIi32 ", expected %" PRIi32 "!\n",
+      what, call->result, expected);
+    exit(1);
+  }
+}
+
+void check_trap(const char* what, const call_t* call) {
+  if (call->called != 1 || !call->trapped) {
+    printf("> Error: %s did not trap!\n", what);
+    exit(1);
+  }
+}
+
+
+const wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+
+#define N 8
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("async-call.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  own wasm_functype_t* host_type = wasm_functype_new_2_1(
+    wasm_valtype_new_i32(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_func_t* host_func = wasm_func_new(store, host_type, host_callback);
+  wasm_functype_delete(host_type);
+  wasm_extern_t* externs[] = { wasm_func_as_extern(host_func) };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  wasm_func_delete(host_func);
+
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  const wasm_func_t* add = get_export_func(&exports, 0);
+  const wasm_func_t* div = get_export_func(&exports, 1);
+  const wasm_func_t* call_host = get_export_func(&exports, 5);
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Queue calls; callbacks only run from wasm_store_run_pending.
+  printf("Queueing calls...\n");
+  call_t calls[N + 1];
+  for (int i = 0; i < N; ++i) {
+    call_async(store, i % 2 ? add : call_host,
+      (wasm_val_t)WASM_I32_VAL(i), (wasm_val_t)WASM_I32_VAL(i), &calls[i]);
+  }
+  call_async(store, div,
+    (wasm_val_t)WASM_I32_VAL(1), (wasm_val_t)WASM_I32_VAL(0), &calls[N]);
+  for (int i = 0; i <= N; ++i) {
+    if (calls[i].called) {
+      printf("> Error: callback ran before wasm_store_run_pending!\n");
+      return 1;
+    }
+  }
+
+  printf("Running calls...\n");
+  size_t delivered = 0;
+  while (delivered < N + 1) delivered += wasm_store_run_pending(store, true);
+  if (delivered != N + 1) {
+    printf("> Error: %zu calls delivered, expected %d!\n", delivered, N + 1);
+    return 1;
+  }
+  for (int i = 0; i < N; ++i) {
+    check_result(i % 2 ? "add" : "call_host", &calls[i], i % 2 ? i + i : i * i);
+  }
+  check_trap("div(1, 0)", &calls[N]);
+  printf("> %zu calls delivered\n", delivered);
+
+  // Arguments of the wrong kind are reported as a trap.
+  printf("Calling with wrong arguments...\n");
+  call_t call;
+  call_async(store, add,
+    (wasm_val_t)WASM_I64_VAL(1), (wasm_val_t)WASM_I64_VAL(2), &call);
+  wasm_store_run_pending(store, false);
+  check_trap("add(1i64, 2i64)", &call);
+
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <vector>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// A function to be called from Wasm code.
+auto host_callback(
+  const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  results[0] = wasm::Val::i32(args[0].i32() * args[1].i32());
+  return nullptr;
+}
+
+
+auto get_export_func(const wasm::Instance* instance, const char* name)
+-> wasm::own<wasm::Func> {
+  auto export_ = instance->export_by_name(name);
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export " << name << "!" << std::endl;
+    exit(1);
+  }
+  return export_->func()->copy();
+}
+
+// Checks an i32 result, printing an error and returning false on mismatch.
+auto check_result(const wasm::Func::CallResult& result, int32_t expected) -> bool {
+  if (result.trap) {
+    std::cout << "> Error: call trapped: " << result.trap.get() << std::endl;
+    return false;
+  }
+  if (result.results.size() != 1 || result.results[0].i32() != expected) {
+    std::cout << "> Error: wrong result, expected " << expected << "!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+auto check_trap(const wasm::Func::CallResult& result, const char* what) -> bool {
+  if (!result.trap) {
+    std::cout << "> Error: " << what << " did not trap!" << std::endl;
+    return false;
+  }
+  std::cout << "> " << what << " trapped: " << result.trap.get() << std::endl;
+  return true;
+}
+
+struct Callback {
+  bool called = false;
+  bool ok = false;
+};
+
+void add_callback(void* env, wasm::Func::CallResult& result) {
+  auto callback = static_cast<Callback*>(env);
+  callback->called = true;
+  callback->ok = check_result(result, 42);
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("async-call.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto host_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(
+      wasm::ValType::make(wasm::ValKind::I32), wasm::ValType::make(wasm::ValKind::I32)),
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32))
+  );
+  auto host_func = wasm::Func::make(store, host_type.get(), host_callback);
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  auto add = get_export_func(instance.get(), "add");
+  auto div = get_export_func(instance.get(), "div");
+  auto call_host = get_export_func(instance.get(), "call_host");
+
+  // Queue calls from another thread, which waits for their results while
+  // this thread runs them. Copies of the functions are made on this thread
+  // and handed over to the calls.
+  std::cout << "Calling from another thread..." << std::endl;
+  const int n = 8;
+  std::vector<wasm::own<wasm::Func>> funcs;
+  for (int i = 0; i < n; ++i) funcs.push_back((i % 2 ? add : call_host)->copy());
+  funcs.push_back(div->copy());
+  bool thread_ok = true;
+  std::thread thread([&]() {
+    std::vector<std::future<wasm::Func::CallResult>> futures;
+    for (int i = 0; i < n; ++i) {
+      futures.push_back(wasm::Func::call_async(std::move(funcs[i]), store,
+        wasm::vec<wasm::Val>::make(wasm::Val::i32(i), wasm::Val::i32(i))));
+    }
+    futures.push_back(wasm::Func::call_async(std::move(funcs[n]), store,
+      wasm::vec<wasm::Val>::make(wasm::Val::i32(1), wasm::Val::i32(0))));
+    for (int i = 0; i < n; ++i) {
+      if (!check_result(futures[i].get(), i % 2 ? i + i : i * i)) thread_ok = false;
+    }
+    if (!check_trap(futures[n].get(), "div(1, 0)")) thread_ok = false;
+  });
+  size_t delivered = 0;
+  while (delivered < n + 1) delivered += store->run_pending(true);
+  thread.join();
+  if (!thread_ok || delivered != n + 1) {
+    std::cout << "> Error: " << delivered << " calls delivered, expected "
+      << n + 1 << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << delivered << " calls delivered" << std::endl;
+
+  // Callbacks run on this thread, from run_pending. The call keeps the
+  // function alive after the caller dropped it.
+  std::cout << "Calling with callback..." << std::endl;
+  Callback callback;
+  auto add_copy = add->copy();
+  add_copy->call_async(store,
+    wasm::vec<wasm::Val>::make(wasm::Val::i32(40), wasm::Val::i32(2)),
+    add_callback, &callback);
+  add_copy.reset();
+  if (callback.called) {
+    std::cout << "> Error: callback ran before run_pending!" << std::endl;
+    exit(1);
+  }
+  while (!callback.called) store->run_pending(true);
+  if (!callback.ok) exit(1);
+
+  // Arguments of the wrong kind are reported as a trap.
+  std::cout << "Calling with wrong arguments..." << std::endl;
+  auto future = add->call_async(store,
+    wasm::vec<wasm::Val>::make(wasm::Val::i64(1), wasm::Val::i64(2)));
+  store->run_pending();
+  if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready ||
+      !check_trap(future.get(), "add(1i64, 2i64)")) {
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
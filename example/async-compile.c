@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Where a compilation delivers its result.
+typedef struct result_t {
+  bool done;
+  own wasm_module_t* module;
+} result_t;
+
+void compiled(void* env, own wasm_module_t* module) {
+  result_t* result = (result_t*)env;
+  if (result->done) {
+    printf("> Error: result delivered twice!\n");
+    exit(1);
+  }
+  printf("Compiled %s...\n", module ? "module" : "nothing");
+  result->done = true;
+  result->module = module;
+}
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm_store_t* store, const wasm_module_t* module, int32_t n) {
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("async-compile.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Start compiling a valid and an invalid binary.
+  printf("Compiling modules...\n");
+  result_t valid = { false, NULL }, invalid = { false, NULL };
+  own wasm_byte_vec_t binary_copy;
+  wasm_byte_vec_copy(&binary_copy, &binary);
+  wasm_module_new_async(store, &binary_copy, compiled, &valid);
+  own wasm_byte_vec_t junk;
+  wasm_name_new_from_string(&junk, "not a module");
+  wasm_module_new_async(store, &junk, compiled, &invalid);
+  if (valid.done || invalid.done) {
+    printf("> Error: result delivered before run_pending!\n");
+    return 1;
+  }
+
+  // Deliver the results.
+  printf("Waiting for results...\n");
+  size_t delivered = 0;
+  while (delivered < 2) delivered += wasm_store_run_pending(store, true);
+  if (delivered != 2 || !valid.done || !invalid.done) {
+    printf("> Error: expected two results, got %zu!\n", delivered);
+    return 1;
+  }
+  if (!valid.module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+  if (invalid.module) {
+    printf("> Error: invalid binary compiled!\n");
+    return 1;
+  }
+  check_module(store, valid.module, 1);
+  wasm_module_delete(valid.module);
+
+  // Deleting a store delivers null for compilations still pending.
+  printf("Deleting store while compiling...\n");
+  result_t dropped = { false, NULL };
+  wasm_store_t* store2 = wasm_store_new(engine);
+  wasm_byte_vec_copy(&binary_copy, &binary);
+  wasm_module_new_async(store2, &binary_copy, compiled, &dropped);
+  wasm_store_delete(store2);
+  if (!dropped.done || dropped.module) {
+    printf("> Error: expected a null result!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
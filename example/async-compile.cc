@@ -0,0 +1,126 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Where a compilation delivers its result.
+struct Result {
+  bool done = false;
+  wasm::own<wasm::Module> module;
+};
+
+void compiled(void* env, wasm::own<wasm::Module>&& module) {
+  auto result = static_cast<Result*>(env);
+  if (result->done) {
+    std::cout << "> Error: result delivered twice!" << std::endl;
+    exit(1);
+  }
+  std::cout << "Compiled " << (module ? "module" : "nothing") << "..." << std::endl;
+  result->done = true;
+  result->module = std::move(module);
+}
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm::Store* store, const wasm::Module* module, int32_t n) {
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module, imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("async-compile.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Start compiling a valid and an invalid binary.
+  std::cout << "Compiling modules..." << std::endl;
+  Result valid, invalid;
+  wasm::Module::make_async(store, binary.copy(), compiled, &valid);
+  wasm::Module::make_async(store,
+    wasm::vec<byte_t>::make(std::string("not a module")), compiled, &invalid);
+  if (valid.done || invalid.done) {
+    std::cout << "> Error: result delivered before run_pending!" << std::endl;
+    exit(1);
+  }
+
+  // Deliver the results.
+  std::cout << "Waiting for results..." << std::endl;
+  size_t delivered = 0;
+  while (delivered < 2) delivered += store->run_pending(true);
+  if (delivered != 2 || !valid.done || !invalid.done) {
+    std::cout << "> Error: expected two results, got " << delivered << "!"
+      << std::endl;
+    exit(1);
+  }
+  if (!valid.module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  if (invalid.module) {
+    std::cout << "> Error: invalid binary compiled!" << std::endl;
+    exit(1);
+  }
+  check_module(store, valid.module.get(), 1);
+
+  // Deleting a store delivers null for compilations still pending.
+  std::cout << "Deleting store while compiling..." << std::endl;
+  Result dropped;
+  auto store2 = wasm::Store::make(engine.get());
+  wasm::Module::make_async(store2.get(), binary.copy(), compiled, &dropped);
+  store2.reset();
+  if (!dropped.done || dropped.module) {
+    std::cout << "> Error: expected a null result!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// A function to be called from Wasm code.
+own wasm_trap_t* host_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  results->data[0].kind = WASM_I32;
+  results->data[0].of.i32 = args->data[0].of.i32 * args->data[1].of.i32;
+  return NULL;
+}
+
+
+const wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+void check_count(
+  const char* what, size_t count, size_t expected,
+  own wasm_trap_t* trap, bool expect_trap
+) {
+  if (!trap != !expect_trap) {
+    printf("> Error: %s %s!\n", what, expect_trap ? "did not trap" : "trapped");
+    exit(1);
+  }
+  if (count != expected) {
+    printf("> Error: %s completed %zu calls, expected %zu!\n", what, count, expected);
+    exit(1);
+  }
+  printf("> %s: %zu calls", what, count);
+  if (trap) {
+    own wasm_message_t message;
+    wasm_trap_message(trap, &message);
+    printf(", trapped: %s", message.data);
+    wasm_byte_vec_delete(&message);
+    wasm_trap_delete(trap);
+  }
+  printf("\n");
+}
+
+void check_i32(const char* what, size_t i, int32_t result, int32_t expected) {
+  if (result != expected) {
+    printf("> Error: %s row %zu = %" PRIi32 ", expected %" PRIi32 "!\n",
+      what, i, result, expected);
+    exit(1);
+  }
+}
+
+void check_i64(const char* what, size_t i, int64_t result, int64_t expected) {
+  if (result != expected) {
+    printf("> Error: %s row %zu = %" PRIi64 ", expected %" PRIi64 "!\n",
+      what, i, result, expected);
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("batch.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  own wasm_functype_t* host_type = wasm_functype_new_2_1(
+    wasm_valtype_new_i32(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_func_t* host_func = wasm_func_new(store, host_type, host_callback);
+  wasm_functype_delete(host_type);
+  wasm_extern_t* externs[] = { wasm_func_as_extern(host_func) };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  wasm_func_delete(host_func);
+
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  const wasm_func_t* div = get_export_func(&exports, 1);
+  const wasm_func_t* swap = get_export_func(&exports, 4);
+  const wasm_func_t* call_host = get_export_func(&exports, 5);
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call in batches of rows.
+  printf("Calling in batches...\n");
+  wasm_val_t args[8], results[4];
+  for (int i = 0; i < 4; ++i) {
+    args[2 * i] = (wasm_val_t)WASM_I32_VAL(10 * i);
+    args[2 * i + 1] = (wasm_val_t)WASM_I32_VAL(i - 2);
+  }
+  own wasm_trap_t* trap = NULL;
+  size_t count = wasm_func_call_batch(call_host, 4, args, results, &trap);
+  check_count("call_host batch", count, 4, trap, false);
+  for (int i = 0; i < 4; ++i) {
+    check_i32("call_host batch", i, results[i].of.i32, 10 * i * (i - 2));
+  }
+
+  // The batch stops at the first trap, here the division by zero.
+  for (int i = 0; i < 4; ++i) results[i] = (wasm_val_t)WASM_I32_VAL(-1);
+  trap = NULL;
+  count = wasm_func_call_batch(div, 4, args, results, &trap);
+  check_count("div batch", count, 2, trap, true);
+  check_i32("div batch", 0, results[0].of.i32, 0 / -2);
+  check_i32("div batch", 1, results[1].of.i32, 10 / -1);
+  check_i32("div batch", 2, results[2].of.i32, -1);
+
+  // Multiple results are stored row by row.
+  wasm_val_t swap_args[4] = {
+    WASM_I32_VAL(1), WASM_I64_VAL(-1), WASM_I32_VAL(2), WASM_I64_VAL(40) };
+  wasm_val_t swap_results[4];
+  trap = NULL;
+  count = wasm_func_call_batch(swap, 2, swap_args, swap_results, &trap);
+  check_count("swap batch", count, 2, trap, false);
+  check_i64("swap batch", 0, swap_results[0].of.i64, -1);
+  check_i32("swap batch", 0, swap_results[1].of.i32, 1);
+  check_i64("swap batch", 1, swap_results[2].of.i64, 40);
+  check_i32("swap batch", 1, swap_results[3].of.i32, 2);
+
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
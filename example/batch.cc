@@ -0,0 +1,137 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+auto get_export_func(const wasm::Instance* instance, const char* name)
+-> wasm::own<wasm::Func> {
+  auto export_ = instance->export_by_name(name);
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export " << name << "!" << std::endl;
+    exit(1);
+  }
+  return export_->func()->copy();
+}
+
+void check_count(const char* what, size_t count, size_t expected,
+  const wasm::own<wasm::Trap>& trap, bool expect_trap
+) {
+  if (!trap != !expect_trap) {
+    std::cout << "> Error: " << what << (expect_trap ? " did not trap" : " trapped")
+      << "!" << std::endl;
+    exit(1);
+  }
+  if (count != expected) {
+    std::cout << "> Error: " << what << " completed " << count << " calls, expected "
+      << expected << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << what << ": " << count << " calls";
+  if (trap) std::cout << ", trapped: " << trap->message().get();
+  std::cout << std::endl;
+}
+
+template<class T>
+void check_result(const char* what, size_t i, T result, T expected) {
+  if (result != expected) {
+    std::cout << "> Error: " << what << " row " << i << " = " << result
+      << ", expected " << expected << "!" << std::endl;
+    exit(1);
+  }
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("batch.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto host_func = wasm::Func::make<int32_t(int32_t, int32_t)>(store,
+    [](int32_t x, int32_t y) { return x * y; });
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  auto div = get_export_func(instance.get(), "div");
+  auto swap = get_export_func(instance.get(), "swap");
+  auto call_host = get_export_func(instance.get(), "call_host");
+
+  // Call in batches of rows.
+  std::cout << "Calling in batches..." << std::endl;
+  const size_t n = 4;
+  wasm::Val args[2 * n], results[n];
+  for (size_t i = 0; i < n; ++i) {
+    args[2 * i] = wasm::Val::i32(int32_t(10 * i));
+    args[2 * i + 1] = wasm::Val::i32(int32_t(i) - 2);
+  }
+  wasm::own<wasm::Trap> trap;
+  auto count = call_host->call_batch(n, args, results, &trap);
+  check_count("call_host batch", count, n, trap, false);
+  for (size_t i = 0; i < n; ++i) {
+    check_result("call_host batch", i, results[i].i32(),
+      int32_t(10 * i) * (int32_t(i) - 2));
+  }
+
+  // The batch stops at the first trap, here the division by zero.
+  for (size_t i = 0; i < n; ++i) results[i] = wasm::Val::i32(-1);
+  count = div->call_batch(n, args, results, &trap);
+  check_count("div batch", count, 2, trap, true);
+  check_result("div batch", 0, results[0].i32(), 0 / -2);
+  check_result("div batch", 1, results[1].i32(), 10 / -1);
+  check_result("div batch", 2, results[2].i32(), -1);
+
+  // Multiple results are stored row by row.
+  wasm::Val swap_args[] = {
+    wasm::Val::i32(1), wasm::Val::i64(-1), wasm::Val::i32(2), wasm::Val::i64(40)};
+  wasm::Val swap_results[4];
+  trap.reset();
+  count = swap->call_batch(2, swap_args, swap_results, &trap);
+  check_count("swap batch", count, 2, trap, false);
+  check_result("swap batch", 0, swap_results[0].i64(), int64_t(-1));
+  check_result("swap batch", 0, swap_results[1].i32(), 1);
+  check_result("swap batch", 1, swap_results[2].i64(), int64_t(40));
+  check_result("swap batch", 1, swap_results[3].i32(), 2);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,21 @@
+(module
+  (func $host (import "" "host") (param i32 i32) (result i32))
+  (func (export "add") (param i32 i32) (result i32)
+    (i32.add (local.get 0) (local.get 1))
+  )
+  (func (export "div") (param i32 i32) (result i32)
+    (i32.div_s (local.get 0) (local.get 1))
+  )
+  (func (export "mul") (param i64 i64) (result i64)
+    (i64.mul (local.get 0) (local.get 1))
+  )
+  (func (export "scale") (param f64 f64) (result f64)
+    (f64.mul (local.get 0) (local.get 1))
+  )
+  (func (export "swap") (param i32 i64) (result i64 i32)
+    (local.get 1) (local.get 0)
+  )
+  (func (export "call_host") (param i32 i32) (result i32)
+    (call $host (local.get 0) (local.get 1))
+  )
+)
@@ -0,0 +1,280 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+const int N = 1000000;
+
+template<class F>
+void bench(const char* name, F f, int n = N, int per_iteration = 1) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) f(i);
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+  std::cout << "> " << name << ": "
+    << static_cast<double>(ns.count()) / n / per_iteration << " ns/op"
+    << std::endl;
+}
+
+
+// Host functions, in vector and raw form.
+auto host_callback(
+  const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  results[0] = wasm::Val::i32(args[0].i32() + args[1].i32());
+  return nullptr;
+}
+
+auto host_callback_with_env(
+  void* env, const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  return host_callback(args, results);
+}
+
+auto host_callback_raw(void* env, uint64_t slots[]) -> wasm::own<wasm::Trap> {
+  auto x = wasm::raw_decode<int32_t>(slots[0]);
+  auto y = wasm::raw_decode<int32_t>(slots[1]);
+  slots[0] = wasm::raw_encode(x + y);
+  return nullptr;
+}
+
+
+auto get_export_func(const wasm::ownvec<wasm::Extern>& exports, size_t i) -> const wasm::Func* {
+  if (exports.size() <= i || !exports[i]->func()) {
+    std::cout << "> Error accessing function export " << i << "!" << std::endl;
+    exit(1);
+  }
+  return exports[i]->func();
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("bench-call.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create host functions.
+  std::cout << "Creating callbacks..." << std::endl;
+  auto host_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(
+      wasm::ValType::make(wasm::ValKind::I32),
+      wasm::ValType::make(wasm::ValKind::I32)),
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32))
+  );
+  auto host_func = wasm::Func::make(store, host_type.get(), host_callback);
+  auto host_func_raw = wasm::Func::make_raw(
+    store, host_type.get(), host_callback_raw, nullptr);
+  auto host_func_typed = wasm::Func::make<int32_t(int32_t, int32_t)>(store,
+    [](int32_t x, int32_t y) { return x + y; });
+  if (!host_func || !host_func_raw || !host_func_typed) {
+    std::cout << "> Error creating callbacks!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  auto imports_raw = wasm::vec<wasm::Extern*>::make(host_func_raw.get());
+  auto instance_raw = wasm::Instance::make(store, module.get(), imports_raw);
+  auto imports_typed = wasm::vec<wasm::Extern*>::make(host_func_typed.get());
+  auto instance_typed = wasm::Instance::make(store, module.get(), imports_typed);
+  if (!instance || !instance_raw || !instance_typed) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract exports.
+  std::cout << "Extracting exports..." << std::endl;
+  auto exports = instance->exports();
+  auto nop_func = get_export_func(exports, 0);
+  auto add_func = get_export_func(exports, 1);
+  auto call_host_func = get_export_func(exports, 2);
+  auto exports_raw = instance_raw->exports();
+  auto call_host_raw_func = get_export_func(exports_raw, 2);
+  auto exports_typed = instance_typed->exports();
+  auto call_host_typed_func = get_export_func(exports_typed, 2);
+
+  // Measure.
+  std::cout << "Measuring " << N << " calls each..." << std::endl;
+  bench("add type()", [&](int) {
+    add_func->type();
+  });
+  auto no_args = wasm::vec<wasm::Val>::make();
+  auto no_results = wasm::vec<wasm::Val>::make();
+  bench("nop call()", [&](int) {
+    nop_func->call(no_args, no_results);
+  });
+  bench("add call()", [&](int i) {
+    auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(i), wasm::Val::i32(1));
+    auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+    add_func->call(args, results);
+  });
+  // Calls used to rebuild the function type every time; this repeats that
+  // work, as a baseline for call() with cached signatures.
+  bench("add type() + call()", [&](int i) {
+    auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(i), wasm::Val::i32(1));
+    auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+    add_func->type();
+    add_func->call(args, results);
+  });
+  bench("add call_unchecked()", [&](int i) {
+    wasm::Val args[] = {wasm::Val::i32(i), wasm::Val::i32(1)};
+    wasm::Val results[1];
+    add_func->call_unchecked(args, results);
+  });
+  auto add = wasm::TypedFunc<int32_t(int32_t, int32_t)>::bind(add_func);
+  if (!add) {
+    std::cout << "> Error binding typed function!" << std::endl;
+    exit(1);
+  }
+  bench("add TypedFunc::call()", [&](int i) {
+    int32_t result;
+    add.call(i, 1, &result);
+  });
+  const int B = 1000;
+  auto batch_args = std::unique_ptr<wasm::Val[]>(new wasm::Val[2 * B]);
+  auto batch_results = std::unique_ptr<wasm::Val[]>(new wasm::Val[B]);
+  bench("add call_batch()", [&](int i) {
+    for (int j = 0; j < B; ++j) {
+      batch_args[2 * j] = wasm::Val::i32(i);
+      batch_args[2 * j + 1] = wasm::Val::i32(j);
+    }
+    add_func->call_batch(B, batch_args.get(), batch_results.get());
+  }, N / B, B);
+  int32_t column_x[B], column_y[B], column_sum[B];
+  wasm::Column column_params[] = {
+    wasm::Column::of(column_x), wasm::Column::of(column_y)};
+  wasm::Column column_results[] = {wasm::Column::of(column_sum)};
+  bench("add call_columns()", [&](int i) {
+    for (int j = 0; j < B; ++j) {
+      column_x[j] = i;
+      column_y[j] = j;
+    }
+    add_func->call_columns(B, column_params, column_results);
+  }, N / B, B);
+  auto futures = std::unique_ptr<std::future<wasm::Func::CallResult>[]>(
+    new std::future<wasm::Func::CallResult>[B]);
+  bench("add call_async()", [&](int i) {
+    for (int j = 0; j < B; ++j) {
+      auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(i), wasm::Val::i32(j));
+      futures[j] = add_func->call_async(store, std::move(args));
+    }
+    store->run_pending();
+    for (int j = 0; j < B; ++j) futures[j].get();
+  }, N / B, B);
+  bench("call_host call_unchecked()", [&](int i) {
+    wasm::Val args[] = {wasm::Val::i32(i), wasm::Val::i32(1)};
+    wasm::Val results[1];
+    call_host_func->call_unchecked(args, results);
+  });
+  bench("call_host_raw call_unchecked()", [&](int i) {
+    wasm::Val args[] = {wasm::Val::i32(i), wasm::Val::i32(1)};
+    wasm::Val results[1];
+    call_host_raw_func->call_unchecked(args, results);
+  });
+  bench("call_host_typed call_unchecked()", [&](int i) {
+    wasm::Val args[] = {wasm::Val::i32(i), wasm::Val::i32(1)};
+    wasm::Val results[1];
+    call_host_typed_func->call_unchecked(args, results);
+  });
+
+  const int M = 100;
+  std::cout << "Measuring " << M * M << " host function creations each..." << std::endl;
+  bench("Func::make()", [&](int) {
+    for (int j = 0; j < M; ++j) {
+      wasm::Func::make(store, host_type.get(), host_callback);
+    }
+  }, M, M);
+  bench("Func::make_many()", [&](int) {
+    wasm::Func::Def defs[M];
+    for (int j = 0; j < M; ++j) {
+      defs[j] = {host_type.get(), host_callback_with_env, nullptr, nullptr};
+    }
+    wasm::Func::make_many(store, M, defs);
+  }, M, M);
+
+  std::cout << "Measuring " << M * M << " instantiations each..." << std::endl;
+  bench("Instance::make()", [&](int) {
+    for (int j = 0; j < M; ++j) {
+      wasm::Instance::make(store, module.get(), imports_raw);
+    }
+  }, M, M);
+  auto linker = wasm::Linker::make(store);
+  linker->define(wasm::Name::make(std::string("")),
+    wasm::Name::make(std::string("host")), host_func_raw.get());
+  auto instance_pre = linker->resolve(module.get());
+  if (!instance_pre) {
+    std::cout << "> Error resolving imports!" << std::endl;
+    exit(1);
+  }
+  bench("InstancePre::instantiate()", [&](int) {
+    for (int j = 0; j < M; ++j) instance_pre->instantiate();
+  }, M, M);
+
+  std::cout << "Measuring " << N << " export lookups each..." << std::endl;
+  bench("Instance::exports()", [&](int) {
+    instance->exports();
+  });
+  bench("Instance::export_by_name()", [&](int) {
+    instance->export_by_name("add");
+  });
+
+  std::cout << "Measuring " << M * M << " module transfers..." << std::endl;
+  auto shared = module->share();
+  auto store2 = wasm::Store::make(engine.get());
+  bench("Module::obtain()", [&](int) {
+    for (int j = 0; j < M; ++j) wasm::Module::obtain(store2.get(), shared.get());
+  }, M, M);
+  bench("Module::make() on a known binary", [&](int) {
+    for (int j = 0; j < M; ++j) wasm::Module::make(store2.get(), binary);
+  }, M, M);
+
+  std::cout << "Measuring " << M << " store creations each..." << std::endl;
+  bench("Store::make()", [&](int) {
+    wasm::Store::make(engine.get());
+  }, M);
+  auto pool = wasm::StorePool::make(engine.get(), 1, 1);
+  bench("StorePool::acquire()", [&](int) {
+    pool->release(pool->acquire());
+  }, M);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
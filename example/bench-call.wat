@@ -0,0 +1,10 @@
+(module
+  (func $host (import "" "host") (param i32 i32) (result i32))
+  (func (export "nop"))
+  (func (export "add") (param i32 i32) (result i32)
+    (i32.add (local.get 0) (local.get 1))
+  )
+  (func (export "call_host") (param i32 i32) (result i32)
+    (call $host (local.get 0) (local.get 1))
+  )
+)
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm_store_t* store, const wasm_module_t* module, int32_t n) {
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("bulk.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Serialize a module to be deserialized in bulk.
+  printf("Serializing module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+  own wasm_byte_vec_t serialized;
+  wasm_module_serialize(module, &serialized);
+  if (!serialized.data) {
+    printf("> Error serializing module!\n");
+    return 1;
+  }
+  wasm_module_delete(module);
+
+  // An invalid binary, which must fail without affecting the others.
+  own wasm_byte_vec_t invalid;
+  wasm_name_new_from_string(&invalid, "not a module");
+
+  // Create modules in bulk; the duplicates are compiled only once.
+  printf("Creating modules...\n");
+  wasm_module_bulk_item_t items[] = {
+    {&binary, false, NULL, 0},
+    {&invalid, false, NULL, 0},
+    {&serialized, true, NULL, 0},
+    {&binary, false, NULL, 0},
+    {&binary, false, NULL, 0},
+  };
+  const size_t n = sizeof(items) / sizeof(items[0]);
+  uint64_t time_ns = wasm_module_new_many(store, n, items, 2);
+  printf("> %zu items in %" PRIu64 " ns\n", n, time_ns);
+
+  // Check results.
+  printf("Checking modules...\n");
+  for (size_t i = 0; i < n; ++i) {
+    bool expect_valid = items[i].bytes != &invalid;
+    if (!items[i].module != !expect_valid) {
+      printf("> Error: item %zu should %shave a module!\n",
+        i, expect_valid ? "" : "not ");
+      return 1;
+    }
+    if (items[i].time_ns > time_ns) {
+      printf("> Error: item %zu took longer than all items!\n", i);
+      return 1;
+    }
+    if (items[i].module) {
+      check_module(store, items[i].module, (int32_t)i);
+    } else {
+      printf("> item %zu failed\n", i);
+    }
+  }
+  if (wasm_module_hash(items[0].module) != wasm_module_hash(items[3].module) ||
+      wasm_module_hash(items[0].module) != wasm_module_hash(items[4].module)) {
+    printf("> Error: duplicates have different hashes!\n");
+    return 1;
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    if (items[i].module) wasm_module_delete(items[i].module);
+  }
+  wasm_byte_vec_delete(&binary);
+  wasm_byte_vec_delete(&serialized);
+  wasm_byte_vec_delete(&invalid);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
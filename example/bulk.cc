@@ -0,0 +1,117 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm::Store* store, const wasm::Module* module, int32_t n) {
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module, imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("bulk.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Serialize a module to be deserialized in bulk.
+  std::cout << "Serializing module..." << std::endl;
+  auto serialized = wasm::Module::make(store, binary)->serialize();
+  if (!serialized) {
+    std::cout << "> Error serializing module!" << std::endl;
+    exit(1);
+  }
+
+  // An invalid binary, which must fail without affecting the others.
+  auto invalid = wasm::vec<byte_t>::make(std::string("not a module"));
+
+  // Create modules in bulk; the duplicates are compiled only once.
+  std::cout << "Creating modules..." << std::endl;
+  wasm::Module::BulkItem items[] = {
+    {&binary, false, nullptr, 0},
+    {&invalid, false, nullptr, 0},
+    {&serialized, true, nullptr, 0},
+    {&binary, false, nullptr, 0},
+    {&binary, false, nullptr, 0},
+  };
+  const size_t n = sizeof(items) / sizeof(items[0]);
+  auto time_ns = wasm::Module::make_many(store, n, items, 2);
+  std::cout << "> " << n << " items in " << time_ns << " ns" << std::endl;
+
+  // Check results.
+  std::cout << "Checking modules..." << std::endl;
+  for (size_t i = 0; i < n; ++i) {
+    auto expect_valid = items[i].bytes != &invalid;
+    if (!items[i].module != !expect_valid) {
+      std::cout << "> Error: item " << i << " should "
+        << (expect_valid ? "" : "not ") << "have a module!" << std::endl;
+      exit(1);
+    }
+    if (items[i].time_ns > time_ns) {
+      std::cout << "> Error: item " << i << " took longer than all items!"
+        << std::endl;
+      exit(1);
+    }
+    if (items[i].module) {
+      check_module(store, items[i].module.get(), static_cast<int32_t>(i));
+    } else {
+      std::cout << "> item " << i << " failed" << std::endl;
+    }
+  }
+  if (items[0].module->hash() != items[3].module->hash() ||
+      items[0].module->hash() != items[4].module->hash()) {
+    std::cout << "> Error: duplicates have different hashes!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
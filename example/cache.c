@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wasm.h"
+
+#define own
+
+// Only one engine can exist per process, so the cache is filled by a first
+// run of this program and used by a second one.
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm_store_t* store, const wasm_module_t* module, int32_t n) {
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+}
+
+uint64_t compile(wasm_store_t* store, const wasm_byte_vec_t* binary, int32_t n) {
+  own wasm_module_t* module = wasm_module_new(store, binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    exit(1);
+  }
+  check_module(store, module, n);
+  uint64_t hash = wasm_module_hash(module);
+  wasm_module_delete(module);
+  return hash;
+}
+
+// Returns the number of entries in the cache directory, and the path of the
+// entry for the given hash, if any.
+size_t scan(const char* dir, uint64_t hash, char* path, size_t path_size) {
+  char prefix[24];
+  snprintf(prefix, sizeof(prefix), "%016" PRIx64 "-", hash);
+  DIR* d = opendir(dir);
+  if (!d) {
+    printf("> Error reading cache directory!\n");
+    exit(1);
+  }
+  size_t count = 0;
+  struct dirent* entry;
+  while ((entry = readdir(d))) {
+    if (entry->d_name[0] == '.') continue;
+    ++count;
+    if (strncmp(entry->d_name, prefix, strlen(prefix)) == 0) {
+      snprintf(path, path_size, "%s/%s", dir, entry->d_name);
+    }
+  }
+  closedir(d);
+  return count;
+}
+
+void stat_file(const char* path, struct stat* st) {
+  if (path[0] == '\0' || stat(path, st) != 0) {
+    printf("> Error: missing cache entry!\n");
+    exit(1);
+  }
+}
+
+
+void load_binaries(wasm_byte_vec_t* binary, wasm_byte_vec_t* binary2) {
+  FILE* file = fopen("cache.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    exit(1);
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_new_uninitialized(binary, file_size);
+  if (fread(binary->data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    exit(1);
+  }
+  fclose(file);
+
+  // A different binary with the same code, by appending a custom section.
+  const char custom[] = {0, 4, 3, 'x', 'y', 'z'};
+  wasm_byte_vec_new_uninitialized(binary2, file_size + sizeof(custom));
+  memcpy(binary2->data, binary->data, file_size);
+  memcpy(binary2->data + file_size, custom, sizeof(custom));
+}
+
+
+void fill(const char* dir, char* path, char* path2, size_t path_size) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_config_t* config = wasm_config_new();
+  wasm_config_set_code_cache_dir(config, dir);
+  wasm_engine_t* engine = wasm_engine_new_with_config(config);
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binaries.
+  printf("Loading binaries...\n");
+  wasm_byte_vec_t binary, binary2;
+  load_binaries(&binary, &binary2);
+
+  // Compile, which writes the cache in the background.
+  printf("Compiling modules...\n");
+  uint64_t hash = compile(store, &binary, 1);
+  uint64_t hash2 = compile(store, &binary2, 2);
+
+  wasm_byte_vec_delete(&binary);
+  wasm_byte_vec_delete(&binary2);
+
+  // Shut down, which waits for the cache to be written.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // Check cache.
+  printf("Checking cache...\n");
+  path[0] = path2[0] = '\0';
+  scan(dir, hash, path, path_size);
+  if (scan(dir, hash2, path2, path_size) != 2 || !path[0] || !path2[0]) {
+    printf("> Error: expected one cache entry per module!\n");
+    exit(1);
+  }
+}
+
+
+void reuse(const char* dir, const char* path, const char* path2) {
+  // Initialize.
+  printf("Initializing with cache...\n");
+  wasm_config_t* config = wasm_config_new();
+  wasm_config_set_code_cache_dir(config, dir);
+  wasm_engine_t* engine = wasm_engine_new_with_config(config);
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binaries.
+  printf("Loading binaries...\n");
+  wasm_byte_vec_t binary, binary2;
+  load_binaries(&binary, &binary2);
+  struct stat st;
+  stat_file(path, &st);
+
+  // Corrupt the second entry, before it is loaded.
+  printf("Corrupting cache entry...\n");
+  FILE* file = fopen(path2, "wb");
+  if (!file || fwrite("junk", 4, 1, file) != 1 || fclose(file) != 0) {
+    printf("> Error corrupting cache entry!\n");
+    exit(1);
+  }
+
+  // Loading from the cache leaves the entry alone.
+  printf("Loading from cache...\n");
+  compile(store, &binary, 3);
+  struct stat st_after;
+  stat_file(path, &st_after);
+  if (st_after.st_ino != st.st_ino || st_after.st_size != st.st_size) {
+    printf("> Error: cache entry was rewritten!\n");
+    exit(1);
+  }
+
+  // A corrupt entry is ignored, and replaced after compiling.
+  printf("Recompiling corrupt entry...\n");
+  compile(store, &binary2, 4);
+
+  wasm_byte_vec_delete(&binary);
+  wasm_byte_vec_delete(&binary2);
+
+  // Shut down, which waits for the replacement to be written.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+  stat_file(path2, &st_after);
+  if (st_after.st_size <= 4) {
+    printf("> Error: corrupt cache entry was not replaced!\n");
+    exit(1);
+  }
+
+  // Clean up.
+  printf("Removing cache...\n");
+  unlink(path);
+  unlink(path2);
+  if (rmdir(dir) != 0) {
+    printf("> Error: unexpected files in cache directory!\n");
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  if (argc > 3) {
+    reuse(argv[1], argv[2], argv[3]);
+    printf("Done.\n");
+    return 0;
+  }
+  char dir[32];
+  snprintf(dir, sizeof(dir), "cache-c-%ld", (long)getpid());
+  if (mkdir(dir, 0755) != 0) {
+    printf("> Error creating cache directory!\n");
+    return 1;
+  }
+  char path[256], path2[256];
+  fill(dir, path, path2, sizeof(path));
+  printf("Restarting...\n");
+  fflush(stdout);
+  char* const args[] = {(char*)argv[0], dir, path, path2, NULL};
+  execv(argv[0], args);
+  printf("> Error restarting!\n");
+  return 1;
+}
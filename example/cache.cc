@@ -0,0 +1,224 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <cinttypes>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wasm.hh"
+
+// Only one engine can exist per process, so the cache is filled by a first
+// run of this program and used by a second one.
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm::Store* store, const wasm::Module* module, int32_t n) {
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module, imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+auto compile(wasm::Store* store, const wasm::vec<byte_t>& binary, int32_t n)
+-> uint64_t {
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  check_module(store, module.get(), n);
+  return module->hash();
+}
+
+// Returns the number of entries in the cache directory, and the path of the
+// entry for the given hash, if any.
+auto scan(const std::string& dir, uint64_t hash, std::string* path) -> size_t {
+  char prefix[24];
+  snprintf(prefix, sizeof(prefix), "%016" PRIx64 "-", hash);
+  auto d = opendir(dir.c_str());
+  if (!d) {
+    std::cout << "> Error reading cache directory!" << std::endl;
+    exit(1);
+  }
+  size_t count = 0;
+  while (auto entry = readdir(d)) {
+    if (entry->d_name[0] == '.') continue;
+    ++count;
+    if (std::strncmp(entry->d_name, prefix, std::strlen(prefix)) == 0) {
+      *path = dir + "/" + entry->d_name;
+    }
+  }
+  closedir(d);
+  return count;
+}
+
+auto stat_file(const std::string& path) -> struct stat {
+  struct stat st;
+  if (path.empty() || stat(path.c_str(), &st) != 0) {
+    std::cout << "> Error: missing cache entry!" << std::endl;
+    exit(1);
+  }
+  return st;
+}
+
+
+auto load_binary() -> wasm::vec<byte_t> {
+  std::ifstream file("cache.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+  return binary;
+}
+
+// A different binary with the same code, by appending a custom section.
+auto load_binary2() -> wasm::vec<byte_t> {
+  auto binary = load_binary();
+  const char custom[] = {0, 4, 3, 'x', 'y', 'z'};
+  auto binary2 =
+    wasm::vec<byte_t>::make_uninitialized(binary.size() + sizeof(custom));
+  std::memcpy(binary2.get(), binary.get(), binary.size());
+  std::memcpy(binary2.get() + binary.size(), custom, sizeof(custom));
+  return binary2;
+}
+
+
+void fill(const std::string& dir, std::string* path, std::string* path2) {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto config = wasm::Config::make();
+  config->set_code_cache_dir(dir);
+  auto engine = wasm::Engine::make(std::move(config));
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binaries.
+  std::cout << "Loading binaries..." << std::endl;
+  auto binary = load_binary();
+  auto binary2 = load_binary2();
+
+  // Compile, which writes the cache in the background.
+  std::cout << "Compiling modules..." << std::endl;
+  auto hash = compile(store, binary, 1);
+  auto hash2 = compile(store, binary2, 2);
+
+  // Shut down, which waits for the cache to be written.
+  std::cout << "Shutting down..." << std::endl;
+  store_.reset();
+  engine.reset();
+
+  // Check cache.
+  std::cout << "Checking cache..." << std::endl;
+  scan(dir, hash, path);
+  if (scan(dir, hash2, path2) != 2 || path->empty() || path2->empty()) {
+    std::cout << "> Error: expected one cache entry per module!" << std::endl;
+    exit(1);
+  }
+}
+
+
+void reuse(
+  const std::string& dir, const std::string& path, const std::string& path2
+) {
+  // Initialize.
+  std::cout << "Initializing with cache..." << std::endl;
+  auto config = wasm::Config::make();
+  config->set_code_cache_dir(dir);
+  auto engine = wasm::Engine::make(std::move(config));
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binaries.
+  std::cout << "Loading binaries..." << std::endl;
+  auto binary = load_binary();
+  auto binary2 = load_binary2();
+  auto st = stat_file(path);
+
+  // Corrupt the second entry, before it is loaded.
+  std::cout << "Corrupting cache entry..." << std::endl;
+  if (truncate(path2.c_str(), 4) != 0) {
+    std::cout << "> Error corrupting cache entry!" << std::endl;
+    exit(1);
+  }
+
+  // Loading from the cache leaves the entry alone.
+  std::cout << "Loading from cache..." << std::endl;
+  compile(store, binary, 3);
+  auto st_after = stat_file(path);
+  if (st_after.st_ino != st.st_ino || st_after.st_size != st.st_size) {
+    std::cout << "> Error: cache entry was rewritten!" << std::endl;
+    exit(1);
+  }
+
+  // A corrupt entry is ignored, and replaced after compiling.
+  std::cout << "Recompiling corrupt entry..." << std::endl;
+  compile(store, binary2, 4);
+
+  // Shut down, which waits for the replacement to be written.
+  std::cout << "Shutting down..." << std::endl;
+  store_.reset();
+  engine.reset();
+  if (stat_file(path2).st_size <= 4) {
+    std::cout << "> Error: corrupt cache entry was not replaced!" << std::endl;
+    exit(1);
+  }
+
+  // Clean up.
+  std::cout << "Removing cache..." << std::endl;
+  unlink(path.c_str());
+  unlink(path2.c_str());
+  if (rmdir(dir.c_str()) != 0) {
+    std::cout << "> Error: unexpected files in cache directory!" << std::endl;
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  if (argc > 3) {
+    reuse(argv[1], argv[2], argv[3]);
+    std::cout << "Done." << std::endl;
+    return 0;
+  }
+  auto dir = "cache-cc-" + std::to_string(getpid());
+  if (mkdir(dir.c_str(), 0755) != 0) {
+    std::cout << "> Error creating cache directory!" << std::endl;
+    return 1;
+  }
+  std::string path, path2;
+  fill(dir, &path, &path2);
+  std::cout << "Restarting..." << std::endl;
+  const char* args[] = {
+    argv[0], dir.c_str(), path.c_str(), path2.c_str(), nullptr};
+  execv(argv[0], const_cast<char* const*>(args));
+  std::cout << "> Error restarting!" << std::endl;
+  return 1;
+}
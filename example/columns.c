@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// A function to be called from Wasm code.
+own wasm_trap_t* host_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  results->data[0].kind = WASM_I32;
+  results->data[0].of.i32 = args->data[0].of.i32 * args->data[1].of.i32;
+  return NULL;
+}
+
+
+const wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+void check_count(
+  const char* what, size_t count, size_t expected,
+  own wasm_trap_t* trap, bool expect_trap
+) {
+  if (!trap != !expect_trap) {
+    printf("> Error: %s %s!\n", what, expect_trap ? "did not trap" : "trapped");
+    exit(1);
+  }
+  if (count != expected) {
+    printf("> Error: %s completed %zu calls, expected %zu!\n", what, count, expected);
+    exit(1);
+  }
+  printf("> %s: %zu calls", what, count);
+  if (trap) {
+    own wasm_message_t message;
+    wasm_trap_message(trap, &message);
+    printf(", trapped: %s", message.data);
+    wasm_byte_vec_delete(&message);
+    wasm_trap_delete(trap);
+  }
+  printf("\n");
+}
+
+void check_i32(const char* what, size_t i, int32_t result, int32_t expected) {
+  if (result != expected) {
+    printf("> Error: %s row %zu = %" PRIi32 ", expected %" PRIi32 "!\n",
+      what, i, result, expected);
+    exit(1);
+  }
+}
+
+
+#define N 1000
+
+int32_t xs[N], ys[N], sums[N], quotients[N];
+double fs[N], gs[N], products[N];
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("columns.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  own wasm_functype_t* host_type = wasm_functype_new_2_1(
+    wasm_valtype_new_i32(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_func_t* host_func = wasm_func_new(store, host_type, host_callback);
+  wasm_functype_delete(host_type);
+  wasm_extern_t* externs[] = { wasm_func_as_extern(host_func) };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  wasm_func_delete(host_func);
+
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  const wasm_func_t* add = get_export_func(&exports, 0);
+  const wasm_func_t* div = get_export_func(&exports, 1);
+  const wasm_func_t* scale = get_export_func(&exports, 3);
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call with columns, spanning several chunks.
+  printf("Calling with columns...\n");
+  for (int i = 0; i < N; ++i) {
+    xs[i] = i * 3;
+    ys[i] = 700 - i;
+    quotients[i] = -1;
+    fs[i] = 0.5 * i;
+    gs[i] = -2.0;
+  }
+  wasm_column_t params[2] = { {WASM_I32, xs}, {WASM_I32, ys} };
+  wasm_column_t sum_results[1] = { {WASM_I32, sums} };
+  own wasm_trap_t* trap = NULL;
+  size_t count = wasm_func_call_columns(add, N, params, sum_results, &trap);
+  check_count("add columns", count, N, trap, false);
+  for (int i = 0; i < N; ++i) check_i32("add columns", i, sums[i], xs[i] + ys[i]);
+
+  wasm_column_t f64_params[2] = { {WASM_F64, fs}, {WASM_F64, gs} };
+  wasm_column_t product_results[1] = { {WASM_F64, products} };
+  trap = NULL;
+  count = wasm_func_call_columns(scale, N, f64_params, product_results, &trap);
+  check_count("scale columns", count, N, trap, false);
+  for (int i = 0; i < N; ++i) {
+    if (products[i] != fs[i] * gs[i]) {
+      printf("> Error: scale columns row %d = %g!\n", i, products[i]);
+      return 1;
+    }
+  }
+
+  // ys[700] is zero, so the call in row 700 traps; earlier rows are stored.
+  wasm_column_t quotient_results[1] = { {WASM_I32, quotients} };
+  trap = NULL;
+  count = wasm_func_call_columns(div, N, params, quotient_results, &trap);
+  check_count("div columns", count, 700, trap, true);
+  for (int i = 0; i < 700; ++i) {
+    check_i32("div columns", i, quotients[i], xs[i] / ys[i]);
+  }
+  check_i32("div columns", 700, quotients[700], -1);
+
+  // Columns of the wrong kind trap before any call.
+  for (int i = 0; i < N; ++i) sums[i] = -1;
+  trap = NULL;
+  count = wasm_func_call_columns(add, N, f64_params, sum_results, &trap);
+  check_count("add with f64 columns", count, 0, trap, true);
+  trap = NULL;
+  count = wasm_func_call_columns(add, N, params, product_results, &trap);
+  check_count("add with f64 result column", count, 0, trap, true);
+  for (int i = 0; i < N; ++i) check_i32("add with f64 columns", i, sums[i], -1);
+
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+auto get_export_func(const wasm::Instance* instance, const char* name)
+-> wasm::own<wasm::Func> {
+  auto export_ = instance->export_by_name(name);
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export " << name << "!" << std::endl;
+    exit(1);
+  }
+  return export_->func()->copy();
+}
+
+void check_count(const char* what, size_t count, size_t expected,
+  const wasm::own<wasm::Trap>& trap, bool expect_trap
+) {
+  if (!trap != !expect_trap) {
+    std::cout << "> Error: " << what << (expect_trap ? " did not trap" : " trapped")
+      << "!" << std::endl;
+    exit(1);
+  }
+  if (count != expected) {
+    std::cout << "> Error: " << what << " completed " << count << " calls, expected "
+      << expected << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << what << ": " << count << " calls";
+  if (trap) std::cout << ", trapped: " << trap->message().get();
+  std::cout << std::endl;
+}
+
+template<class T>
+void check_result(const char* what, size_t i, T result, T expected) {
+  if (result != expected) {
+    std::cout << "> Error: " << what << " row " << i << " = " << result
+      << ", expected " << expected << "!" << std::endl;
+    exit(1);
+  }
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("columns.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto host_func = wasm::Func::make<int32_t(int32_t, int32_t)>(store,
+    [](int32_t x, int32_t y) { return x * y; });
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  auto add = get_export_func(instance.get(), "add");
+  auto div = get_export_func(instance.get(), "div");
+  auto scale = get_export_func(instance.get(), "scale");
+
+  // Call with columns, spanning several chunks.
+  std::cout << "Calling with columns..." << std::endl;
+  const size_t n = 1000;
+  std::vector<int32_t> xs(n), ys(n), sums(n), quotients(n, -1);
+  std::vector<double> fs(n), gs(n), products(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = int32_t(i) * 3;
+    ys[i] = 700 - int32_t(i);
+    fs[i] = 0.5 * i;
+    gs[i] = -2.0;
+  }
+  wasm::Column params[] = {
+    wasm::Column::of(xs.data()), wasm::Column::of(ys.data())};
+  wasm::Column sum_results[] = {wasm::Column::of(sums.data())};
+  wasm::own<wasm::Trap> trap;
+  auto count = add->call_columns(n, params, sum_results, &trap);
+  check_count("add columns", count, n, trap, false);
+  for (size_t i = 0; i < n; ++i) {
+    check_result("add columns", i, sums[i], xs[i] + ys[i]);
+  }
+
+  wasm::Column f64_params[] = {
+    wasm::Column::of(fs.data()), wasm::Column::of(gs.data())};
+  wasm::Column product_results[] = {wasm::Column::of(products.data())};
+  count = scale->call_columns(n, f64_params, product_results, &trap);
+  check_count("scale columns", count, n, trap, false);
+  for (size_t i = 0; i < n; ++i) {
+    check_result("scale columns", i, products[i], fs[i] * gs[i]);
+  }
+
+  // ys[700] is zero, so the call in row 700 traps; earlier rows are stored.
+  wasm::Column quotient_results[] = {wasm::Column::of(quotients.data())};
+  count = div->call_columns(n, params, quotient_results, &trap);
+  check_count("div columns", count, 700, trap, true);
+  for (size_t i = 0; i < 700; ++i) {
+    check_result("div columns", i, quotients[i], xs[i] / ys[i]);
+  }
+  check_result("div columns", 700, quotients[700], -1);
+
+  // Columns of the wrong kind trap before any call.
+  for (size_t i = 0; i < n; ++i) sums[i] = -1;
+  wasm::own<wasm::Trap> mismatch;
+  count = add->call_columns(n, f64_params, sum_results, &mismatch);
+  check_count("add with f64 columns", count, 0, mismatch, true);
+  mismatch.reset();
+  count = add->call_columns(n, params, product_results, &mismatch);
+  check_count("add with f64 result column", count, 0, mismatch, true);
+  for (size_t i = 0; i < n; ++i) {
+    check_result("add with f64 columns", i, sums[i], -1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Functions to be called from Wasm code.
+own wasm_trap_t* twice_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  results->data[0].kind = WASM_I32;
+  results->data[0].of.i32 = 2 * args->data[0].of.i32;
+  return NULL;
+}
+
+own wasm_trap_t* thrice_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  results->data[0].kind = WASM_I32;
+  results->data[0].of.i32 = 3 * args->data[0].of.i32;
+  return NULL;
+}
+
+own wasm_trap_t* wide_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  results->data[0].kind = WASM_I64;
+  results->data[0].of.i64 = 2 * args->data[0].of.i64;
+  return NULL;
+}
+
+
+void check_run(own wasm_instance_t* instance, own wasm_trap_t* trap, int32_t expected) {
+  if (!instance || trap) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0 || !wasm_extern_as_func(exports.data[0])) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  const wasm_func_t* run = wasm_extern_as_func(exports.data[0]);
+  wasm_val_t args_val[1] = { WASM_I32_VAL(10) };
+  wasm_val_t results_val[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(args_val);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(results_val);
+  if (wasm_func_call(run, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (results_val[0].of.i32 != expected) {
+    printf("> Error: run(10) = %" PRIi32 ", expected %" PRIi32 "!\n",
+      results_val[0].of.i32, expected);
+    exit(1);
+  }
+  printf("> run(10) = %" PRIi32 "\n", results_val[0].of.i32);
+  wasm_extern_vec_delete(&exports);
+  wasm_instance_delete(instance);
+}
+
+void check_trap(const char* what, own wasm_instance_pre_t* pre, own wasm_trap_t* trap) {
+  if (pre) {
+    printf("> Error: resolved with %s!\n", what);
+    exit(1);
+  }
+  if (!trap) {
+    printf("> Error: %s failed without a trap!\n", what);
+    exit(1);
+  }
+  own wasm_message_t message;
+  wasm_trap_message(trap, &message);
+  printf("> %s: %s\n", what, message.data);
+  wasm_byte_vec_delete(&message);
+  wasm_trap_delete(trap);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("linker.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create definitions.
+  printf("Creating definitions...\n");
+  own wasm_functype_t* i32_type =
+    wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_functype_t* i64_type =
+    wasm_functype_new_1_1(wasm_valtype_new_i64(), wasm_valtype_new_i64());
+  own wasm_func_t* twice = wasm_func_new(store, i32_type, twice_callback);
+  own wasm_func_t* thrice = wasm_func_new(store, i32_type, thrice_callback);
+  own wasm_func_t* wide = wasm_func_new(store, i64_type, wide_callback);
+  wasm_functype_delete(i32_type);
+  wasm_functype_delete(i64_type);
+
+  own wasm_globaltype_t* offset_type =
+    wasm_globaltype_new(wasm_valtype_new_i32(), WASM_CONST);
+  wasm_val_t offset_val = WASM_I32_VAL(5);
+  own wasm_global_t* offset = wasm_global_new(store, offset_type, &offset_val);
+  wasm_globaltype_delete(offset_type);
+
+  own wasm_name_t env, twice_name, offset_name;
+  wasm_name_new_from_string(&env, "env");
+  wasm_name_new_from_string(&twice_name, "twice");
+  wasm_name_new_from_string(&offset_name, "offset");
+
+  // Resolution fails while imports are missing.
+  printf("Resolving with missing imports...\n");
+  own wasm_linker_t* linker = wasm_linker_new(store);
+  own wasm_trap_t* trap = NULL;
+  own wasm_instance_pre_t* pre = wasm_linker_resolve(linker, module, &trap);
+  check_trap("missing imports", pre, trap);
+
+  // Resolution fails on a type mismatch.
+  printf("Resolving with mismatched import...\n");
+  wasm_linker_define(linker, &env, &twice_name, wasm_func_as_extern(wide));
+  wasm_linker_define(linker, &env, &offset_name, wasm_global_as_extern(offset));
+  pre = wasm_linker_resolve(linker, module, &trap);
+  check_trap("mismatched import", pre, trap);
+
+  // Redefining replaces the mismatched definition.
+  printf("Resolving...\n");
+  wasm_linker_define(linker, &env, &twice_name, wasm_func_as_extern(twice));
+  pre = wasm_linker_resolve(linker, module, &trap);
+  if (!pre || trap) {
+    printf("> Error resolving module!\n");
+    return 1;
+  }
+
+  // Instantiate repeatedly, without looking up imports again.
+  printf("Instantiating module...\n");
+  for (int i = 0; i < 3; ++i) {
+    own wasm_instance_t* instance = wasm_instance_pre_instantiate(pre, &trap);
+    check_run(instance, trap, 25);
+  }
+
+  // Later definitions affect the linker, but not the resolved module.
+  printf("Redefining imports...\n");
+  wasm_linker_define(linker, &env, &twice_name, wasm_func_as_extern(thrice));
+  own wasm_instance_t* instance = wasm_linker_instantiate(linker, module, &trap);
+  check_run(instance, trap, 35);
+  instance = wasm_instance_pre_instantiate(pre, &trap);
+  check_run(instance, trap, 25);
+
+  wasm_instance_pre_delete(pre);
+  wasm_linker_delete(linker);
+  wasm_name_delete(&env);
+  wasm_name_delete(&twice_name);
+  wasm_name_delete(&offset_name);
+  wasm_func_delete(twice);
+  wasm_func_delete(thrice);
+  wasm_func_delete(wide);
+  wasm_global_delete(offset);
+  wasm_module_delete(module);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
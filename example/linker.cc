@@ -0,0 +1,173 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+auto run_export(const wasm::Instance* instance, int32_t arg) -> int32_t {
+  auto export_ = instance->export_by_name("run");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto run = wasm::TypedFunc<int32_t(int32_t)>::bind(export_->func());
+  int32_t result = 0;
+  if (!run || run.call(arg, &result)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  return result;
+}
+
+void check_run(const wasm::Instance* instance, int32_t expected) {
+  auto result = run_export(instance, 10);
+  if (result != expected) {
+    std::cout << "> Error: run(10) = " << result << ", expected " << expected
+      << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> run(10) = " << result << std::endl;
+}
+
+void check_trap(const char* what, const wasm::own<wasm::Trap>& trap) {
+  if (!trap) {
+    std::cout << "> Error: " << what << " failed without a trap!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << what << ": " << trap->message().get() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("linker.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create definitions.
+  std::cout << "Creating definitions..." << std::endl;
+  auto twice = wasm::Func::make<int32_t(int32_t)>(store,
+    [](int32_t x) { return 2 * x; });
+  auto thrice = wasm::Func::make<int32_t(int32_t)>(store,
+    [](int32_t x) { return 3 * x; });
+  auto wide = wasm::Func::make<int64_t(int64_t)>(store,
+    [](int64_t x) { return 2 * x; });
+  auto offset_type = wasm::GlobalType::make(
+    wasm::ValType::make(wasm::ValKind::I32), wasm::Mutability::CONST);
+  auto offset = wasm::Global::make(store, offset_type.get(), wasm::Val::i32(5));
+  if (!twice || !thrice || !wide || !offset) {
+    std::cout << "> Error creating definitions!" << std::endl;
+    exit(1);
+  }
+
+  auto env = wasm::Name::make(std::string("env"));
+  auto twice_name = wasm::Name::make(std::string("twice"));
+  auto offset_name = wasm::Name::make(std::string("offset"));
+
+  // Definitions from another store are refused.
+  std::cout << "Defining import from another store..." << std::endl;
+  auto other_store = wasm::Store::make(engine.get());
+  auto other = wasm::Func::make<int32_t(int32_t)>(other_store.get(),
+    [](int32_t x) { return x; });
+  auto other_linker = wasm::Linker::make(store);
+  if (!other || other_linker->define(env, twice_name, other.get())) {
+    std::cout << "> Error: defined import from another store!" << std::endl;
+    exit(1);
+  }
+  other.reset();
+  other_store.reset();
+
+  // Resolution fails while imports are missing.
+  std::cout << "Resolving with missing imports..." << std::endl;
+  auto linker = wasm::Linker::make(store);
+  wasm::own<wasm::Trap> trap;
+  if (linker->resolve(module.get(), &trap)) {
+    std::cout << "> Error: resolved with missing imports!" << std::endl;
+    exit(1);
+  }
+  check_trap("missing imports", trap);
+
+  // Resolution fails on a type mismatch.
+  std::cout << "Resolving with mismatched import..." << std::endl;
+  linker->define(env, twice_name, wide.get());
+  linker->define(env, offset_name, offset.get());
+  trap.reset();
+  if (linker->resolve(module.get(), &trap)) {
+    std::cout << "> Error: resolved with mismatched import!" << std::endl;
+    exit(1);
+  }
+  check_trap("mismatched import", trap);
+
+  // Redefining replaces the mismatched definition.
+  std::cout << "Resolving..." << std::endl;
+  linker->define(env, twice_name, twice.get());
+  trap.reset();
+  auto pre = linker->resolve(module.get(), &trap);
+  if (!pre || trap) {
+    std::cout << "> Error resolving module!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate repeatedly, without looking up imports again.
+  std::cout << "Instantiating module..." << std::endl;
+  for (int i = 0; i < 3; ++i) {
+    auto instance = pre->instantiate(&trap);
+    if (!instance || trap) {
+      std::cout << "> Error instantiating module!" << std::endl;
+      exit(1);
+    }
+    check_run(instance.get(), 25);
+  }
+
+  // Later definitions affect the linker, but not the resolved module.
+  std::cout << "Redefining imports..." << std::endl;
+  linker->define(env, twice_name, thrice.get());
+  auto instance = linker->instantiate(module.get(), &trap);
+  if (!instance || trap) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  check_run(instance.get(), 35);
+  instance = pre->instantiate(&trap);
+  if (!instance || trap) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  check_run(instance.get(), 25);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
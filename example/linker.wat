@@ -0,0 +1,7 @@
+(module
+  (func $twice (import "env" "twice") (param i32) (result i32))
+  (global $offset (import "env" "offset") i32)
+  (func (export "run") (param i32) (result i32)
+    (i32.add (call $twice (local.get 0)) (global.get $offset))
+  )
+)
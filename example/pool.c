@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Instantiates the module in the given store and checks a call. All
+// references are dropped before returning, so that the store can be reset.
+void check_store(wasm_store_t* store, const wasm_byte_vec_t* binary, int32_t n) {
+  own wasm_module_t* module = wasm_module_new(store, binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    exit(1);
+  }
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+  wasm_module_delete(module);
+}
+
+void check_idle(const wasm_store_pool_t* pool, size_t expected) {
+  size_t idle = wasm_store_pool_idle_count(pool);
+  if (idle != expected) {
+    printf("> Error: %zu idle stores, expected %zu!\n", idle, expected);
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("pool.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Create pool with two warm stores.
+  printf("Creating pool...\n");
+  own wasm_store_pool_t* pool = wasm_store_pool_new(engine, 2, 2);
+  if (!pool) {
+    printf("> Error creating pool!\n");
+    return 1;
+  }
+  check_idle(pool, 2);
+
+  // Acquire more stores than the pool holds.
+  printf("Acquiring stores...\n");
+  own wasm_store_t* store1 = wasm_store_pool_acquire(pool);
+  own wasm_store_t* store2 = wasm_store_pool_acquire(pool);
+  own wasm_store_t* store3 = wasm_store_pool_acquire(pool);
+  if (!store1 || !store2 || !store3) {
+    printf("> Error acquiring store!\n");
+    return 1;
+  }
+  check_idle(pool, 0);
+
+  // Use them interleaved.
+  printf("Using stores...\n");
+  check_store(store2, &binary, 2);
+  check_store(store1, &binary, 1);
+  check_store(store3, &binary, 3);
+
+  // Release out of order; the last one does not fit and is deleted.
+  printf("Releasing stores...\n");
+  wasm_store_pool_release(pool, store1);
+  wasm_store_pool_release(pool, store3);
+  check_idle(pool, 2);
+  check_store(store2, &binary, 4);
+  wasm_store_pool_release(pool, store2);
+  check_idle(pool, 2);
+
+  // Reuse a reset store.
+  printf("Reusing store...\n");
+  own wasm_store_t* store4 = wasm_store_pool_acquire(pool);
+  check_idle(pool, 1);
+  check_store(store4, &binary, 5);
+
+  // Stores outside the pool can be deleted in any order, too.
+  printf("Deleting stores...\n");
+  own wasm_store_t* store5 = wasm_store_new(engine);
+  own wasm_store_t* store6 = wasm_store_new(engine);
+  check_store(store5, &binary, 6);
+  wasm_store_delete(store5);
+  check_store(store6, &binary, 7);
+  check_store(store4, &binary, 8);
+
+  wasm_byte_vec_delete(&binary);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store6);
+  wasm_store_delete(store4);
+  wasm_store_pool_delete(pool);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Instantiates the module in the given store and checks a call. All
+// references are dropped before returning, so that the store can be reset.
+void check_store(wasm::Store* store, const wasm::vec<byte_t>& binary, int32_t n) {
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+void check_idle(const wasm::StorePool* pool, size_t expected) {
+  if (pool->idle_count() != expected) {
+    std::cout << "> Error: " << pool->idle_count() << " idle stores, expected "
+      << expected << "!" << std::endl;
+    exit(1);
+  }
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("pool.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Create pool with two warm stores.
+  std::cout << "Creating pool..." << std::endl;
+  auto pool = wasm::StorePool::make(engine.get(), 2, 2);
+  if (!pool) {
+    std::cout << "> Error creating pool!" << std::endl;
+    exit(1);
+  }
+  check_idle(pool.get(), 2);
+
+  // Acquire more stores than the pool holds.
+  std::cout << "Acquiring stores..." << std::endl;
+  auto store1 = pool->acquire();
+  auto store2 = pool->acquire();
+  auto store3 = pool->acquire();
+  if (!store1 || !store2 || !store3) {
+    std::cout << "> Error acquiring store!" << std::endl;
+    exit(1);
+  }
+  check_idle(pool.get(), 0);
+
+  // Use them interleaved.
+  std::cout << "Using stores..." << std::endl;
+  check_store(store2.get(), binary, 2);
+  check_store(store1.get(), binary, 1);
+  check_store(store3.get(), binary, 3);
+
+  // Release out of order; the last one does not fit and is deleted.
+  std::cout << "Releasing stores..." << std::endl;
+  pool->release(std::move(store1));
+  pool->release(std::move(store3));
+  check_idle(pool.get(), 2);
+  check_store(store2.get(), binary, 4);
+  pool->release(std::move(store2));
+  check_idle(pool.get(), 2);
+
+  // Reuse a reset store.
+  std::cout << "Reusing store..." << std::endl;
+  auto store4 = pool->acquire();
+  check_idle(pool.get(), 1);
+  check_store(store4.get(), binary, 5);
+
+  // Stores outside the pool can be deleted in any order, too.
+  std::cout << "Deleting stores..." << std::endl;
+  auto store5 = wasm::Store::make(engine.get());
+  auto store6 = wasm::Store::make(engine.get());
+  check_store(store5.get(), binary, 6);
+  store5.reset();
+  check_store(store6.get(), binary, 7);
+  check_store(store4.get(), binary, 8);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "wasm.h"
+
+#define own
+
+// A writer appending to a buffer, failing after a given number of pieces.
+typedef struct output_t {
+  wasm_byte_t* data;
+  size_t size;
+  size_t pieces;
+  size_t fail_after;
+} output_t;
+
+bool write_output(void* env, const wasm_byte_t* data, size_t size) {
+  output_t* out = (output_t*)env;
+  if (out->pieces == out->fail_after) return false;
+  wasm_byte_t* grown = realloc(out->data, out->size + size);
+  if (!grown) return false;
+  memcpy(grown + out->size, data, size);
+  out->data = grown;
+  out->size += size;
+  ++out->pieces;
+  return true;
+}
+
+// A reader handing out at most 7 bytes at a time, up to a given limit.
+typedef struct input_t {
+  const wasm_byte_t* data;
+  size_t size;
+  size_t pos;
+} input_t;
+
+size_t read_input(void* env, wasm_byte_t* data, size_t size) {
+  input_t* in = (input_t*)env;
+  size_t n = size < 7 ? size : 7;
+  if (n > in->size - in->pos) n = in->size - in->pos;
+  memcpy(data, in->data + in->pos, n);
+  in->pos += n;
+  return n;
+}
+
+size_t read_fd(void* env, wasm_byte_t* data, size_t size) {
+  ssize_t n = read(*(int*)env, data, size);
+  return n < 0 ? 0 : (size_t)n;
+}
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm_store_t* store, own wasm_module_t* module, int32_t n) {
+  if (!module) {
+    printf("> Error deserializing module!\n");
+    exit(1);
+  }
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+  wasm_module_delete(module);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("serialize-stream.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Serialize in pieces.
+  printf("Serializing module...\n");
+  output_t out = { NULL, 0, 0, SIZE_MAX };
+  if (!wasm_module_serialize_to(module, write_output, &out) || out.size == 0) {
+    printf("> Error serializing module!\n");
+    return 1;
+  }
+  printf("> %zu bytes in %zu pieces\n", out.size, out.pieces);
+
+  // A failing writer aborts serialization.
+  printf("Serializing with failing writer...\n");
+  output_t failing = { NULL, 0, 0, 1 };
+  if (wasm_module_serialize_to(module, write_output, &failing)) {
+    printf("> Error: serialization did not fail!\n");
+    return 1;
+  }
+  free(failing.data);
+
+  // The pieces form the same format as wasm_module_serialize.
+  printf("Deserializing module...\n");
+  wasm_byte_vec_t serialized = { out.size, out.data };
+  check_module(store, wasm_module_deserialize(store, &serialized), 1);
+  free(out.data);
+  own wasm_byte_vec_t whole;
+  wasm_module_serialize(module, &whole);
+  input_t in = { whole.data, whole.size, 0 };
+  check_module(store, wasm_module_deserialize_from(store, read_input, &in), 2);
+
+  // A truncated input fails.
+  printf("Deserializing truncated input...\n");
+  input_t truncated = { whole.data, 3, 0 };
+  own wasm_module_t* broken =
+    wasm_module_deserialize_from(store, read_input, &truncated);
+  if (broken) {
+    printf("> Error: deserialization did not fail!\n");
+    return 1;
+  }
+  wasm_byte_vec_delete(&whole);
+
+  // Serialize to a file and read it back.
+  printf("Serializing to file...\n");
+  const char* path = "serialize-stream-c.data";
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || !wasm_module_serialize_to_fd(module, fd)) {
+    printf("> Error serializing to file!\n");
+    return 1;
+  }
+  lseek(fd, 0, SEEK_SET);
+  check_module(store, wasm_module_deserialize_from(store, read_fd, &fd), 3);
+  close(fd);
+  unlink(path);
+
+  wasm_module_delete(module);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <cinttypes>
+#include <cstdint>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "wasm.hh"
+
+
+// A writer appending to a string, failing after a given number of pieces.
+struct Output {
+  std::string data;
+  size_t pieces;
+  size_t fail_after;
+};
+
+auto write_output(void* env, const byte_t* data, size_t size) -> bool {
+  auto out = static_cast<Output*>(env);
+  if (out->pieces == out->fail_after) return false;
+  ++out->pieces;
+  out->data.append(data, size);
+  return true;
+}
+
+// A reader handing out at most 7 bytes at a time, up to a given limit.
+struct Input {
+  const byte_t* data;
+  size_t size;
+  size_t pos;
+};
+
+auto read_input(void* env, byte_t* data, size_t size) -> size_t {
+  auto in = static_cast<Input*>(env);
+  auto n = std::min(std::min(size, size_t(7)), in->size - in->pos);
+  std::memcpy(data, in->data + in->pos, n);
+  in->pos += n;
+  return n;
+}
+
+auto read_fd(void* env, byte_t* data, size_t size) -> size_t {
+  auto n = read(*static_cast<int*>(env), data, size);
+  return n < 0 ? 0 : n;
+}
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm::Store* store, const wasm::Module* module, int32_t n) {
+  if (!module) {
+    std::cout << "> Error deserializing module!" << std::endl;
+    exit(1);
+  }
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module, imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("serialize-stream.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Serialize in pieces.
+  std::cout << "Serializing module..." << std::endl;
+  Output out{"", 0, SIZE_MAX};
+  if (!module->serialize_to(write_output, &out) || out.data.empty()) {
+    std::cout << "> Error serializing module!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << out.data.size() << " bytes in " << out.pieces
+    << " pieces" << std::endl;
+
+  // A failing writer aborts serialization.
+  std::cout << "Serializing with failing writer..." << std::endl;
+  Output failing{"", 0, 1};
+  if (module->serialize_to(write_output, &failing)) {
+    std::cout << "> Error: serialization did not fail!" << std::endl;
+    exit(1);
+  }
+
+  // The pieces form the same format as serialize().
+  std::cout << "Deserializing module..." << std::endl;
+  auto serialized = wasm::vec<byte_t>::make(out.data);
+  check_module(store, wasm::Module::deserialize(store, serialized).get(), 1);
+  auto whole = module->serialize();
+  Input in{whole.get(), whole.size(), 0};
+  check_module(store,
+    wasm::Module::deserialize_from(store, read_input, &in).get(), 2);
+
+  // A truncated input fails.
+  std::cout << "Deserializing truncated input..." << std::endl;
+  Input truncated{whole.get(), 3, 0};
+  if (wasm::Module::deserialize_from(store, read_input, &truncated)) {
+    std::cout << "> Error: deserialization did not fail!" << std::endl;
+    exit(1);
+  }
+
+  // Serialize to a file and read it back.
+  std::cout << "Serializing to file..." << std::endl;
+  auto path = "serialize-stream-cc.data";
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || !module->serialize_to_fd(fd)) {
+    std::cout << "> Error serializing to file!" << std::endl;
+    exit(1);
+  }
+  lseek(fd, 0, SEEK_SET);
+  check_module(store,
+    wasm::Module::deserialize_from(store, read_fd, &fd).get(), 3);
+  close(fd);
+  unlink(path);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
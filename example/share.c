@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm_store_t* store, const wasm_module_t* module, int32_t n) {
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store1 = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("share.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store1, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  check_module(store1, module, 1);
+
+  // Share.
+  printf("Sharing module...\n");
+  own wasm_shared_module_t* shared = wasm_module_share(module);
+  if (!shared) {
+    printf("> Error sharing module!\n");
+    return 1;
+  }
+
+  // The shared module outlives the store it came from.
+  wasm_module_delete(module);
+  wasm_store_delete(store1);
+
+  // Obtain in another store.
+  printf("Obtaining module...\n");
+  wasm_store_t* store2 = wasm_store_new(engine);
+  own wasm_module_t* module2 = wasm_module_obtain(store2, shared);
+  if (!module2) {
+    printf("> Error obtaining module!\n");
+    return 1;
+  }
+
+  own wasm_exporttype_vec_t exports;
+  wasm_module_exports(module2, &exports);
+  if (exports.size != 1 ||
+      wasm_externtype_kind(wasm_exporttype_type(exports.data[0])) !=
+        WASM_EXTERN_FUNC) {
+    printf("> Error: obtained module has wrong exports!\n");
+    return 1;
+  }
+  wasm_exporttype_vec_delete(&exports);
+
+  check_module(store2, module2, 2);
+
+  wasm_module_delete(module2);
+  wasm_shared_module_delete(shared);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store2);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm::Store* store, const wasm::Module* module, int32_t n) {
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module, imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store1 = wasm::Store::make(engine.get());
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("share.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store1.get(), binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  check_module(store1.get(), module.get(), 1);
+
+  // Share.
+  std::cout << "Sharing module..." << std::endl;
+  auto shared = module->share();
+  if (!shared) {
+    std::cout << "> Error sharing module!" << std::endl;
+    exit(1);
+  }
+
+  // The shared module outlives the store it came from.
+  module.reset();
+  store1.reset();
+
+  // Obtain in another store.
+  std::cout << "Obtaining module..." << std::endl;
+  auto store2 = wasm::Store::make(engine.get());
+  auto module2 = wasm::Module::obtain(store2.get(), shared.get());
+  if (!module2) {
+    std::cout << "> Error obtaining module!" << std::endl;
+    exit(1);
+  }
+  auto exports = module2->exports();
+  if (exports.size() != 1 ||
+      exports[0]->type()->kind() != wasm::ExternKind::FUNC) {
+    std::cout << "> Error: obtained module has wrong exports!" << std::endl;
+    exit(1);
+  }
+  check_module(store2.get(), module2.get(), 2);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
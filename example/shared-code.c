@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm_store_t* store, const wasm_module_t* module, int32_t n) {
+  wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+  own wasm_name_t name;
+  wasm_name_new_from_string(&name, "add");
+  own wasm_extern_t* export_ = wasm_instance_export_by_name(instance, &name);
+  wasm_name_delete(&name);
+  const wasm_func_t* func = export_ ? wasm_extern_as_func(export_) : NULL;
+  if (!func) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+  wasm_val_t vals[2] = { WASM_I32_VAL(n), WASM_I32_VAL(1) };
+  wasm_val_t res[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(vals);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(res);
+  if (wasm_func_call(func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (res[0].of.i32 != n + 1) {
+    printf("> Error: %" PRIi32 " + 1 = %" PRIi32 "!\n", n, res[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 " + 1 = %" PRIi32 "\n", n, res[0].of.i32);
+
+  wasm_extern_delete(export_);
+  wasm_instance_delete(instance);
+}
+
+own wasm_module_t* compile(wasm_store_t* store, const wasm_byte_vec_t* binary) {
+  own wasm_module_t* module = wasm_module_new(store, binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    exit(1);
+  }
+  return module;
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store1 = wasm_store_new(engine);
+  wasm_store_t* store2 = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("shared-code.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // A different binary with the same code, by appending a custom section.
+  const char custom[] = {0, 4, 3, 'x', 'y', 'z'};
+  wasm_byte_vec_t binary2;
+  wasm_byte_vec_new_uninitialized(&binary2, file_size + sizeof(custom));
+  memcpy(binary2.data, binary.data, file_size);
+  memcpy(binary2.data + file_size, custom, sizeof(custom));
+
+  // Compile the same binary in two stores, which share the code.
+  printf("Compiling modules...\n");
+  own wasm_module_t* module1 = compile(store1, &binary);
+  own wasm_module_t* module2 = compile(store2, &binary);
+  own wasm_module_t* module3 = compile(store2, &binary2);
+
+  // Check hashes.
+  printf("Checking hashes...\n");
+  uint64_t hash = wasm_module_hash(module1);
+  printf("> %" PRIx64 "\n", hash);
+  if (wasm_module_hash(module2) != hash) {
+    printf("> Error: same binary has different hashes!\n");
+    return 1;
+  }
+  if (wasm_module_hash(module3) == hash) {
+    printf("> Error: different binaries have the same hash!\n");
+    return 1;
+  }
+  own wasm_module_t* copy = wasm_module_copy(module1);
+  own wasm_byte_vec_t serialized;
+  wasm_module_serialize(module1, &serialized);
+  own wasm_module_t* deserialized = wasm_module_deserialize(store1, &serialized);
+  wasm_byte_vec_delete(&serialized);
+  if (wasm_module_hash(copy) != hash || !deserialized ||
+      wasm_module_hash(deserialized) != hash) {
+    printf("> Error: hash changed!\n");
+    return 1;
+  }
+
+  // Shared code outlives the store that compiled it.
+  printf("Deleting first store...\n");
+  check_module(store1, module1, 1);
+  wasm_module_delete(copy);
+  wasm_module_delete(deserialized);
+  wasm_module_delete(module1);
+  wasm_store_delete(store1);
+  check_module(store2, module2, 2);
+  check_module(store2, module3, 3);
+
+  // A new store picks up the code again.
+  printf("Compiling in new store...\n");
+  wasm_store_t* store3 = wasm_store_new(engine);
+  own wasm_module_t* module4 = compile(store3, &binary);
+  if (wasm_module_hash(module4) != hash) {
+    printf("> Error: same binary has different hashes!\n");
+    return 1;
+  }
+  check_module(store3, module4, 4);
+
+  wasm_module_delete(module2);
+  wasm_module_delete(module3);
+  wasm_module_delete(module4);
+  wasm_byte_vec_delete(&binary);
+  wasm_byte_vec_delete(&binary2);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store3);
+  wasm_store_delete(store2);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+// Instantiates a module and checks a call of its export.
+void check_module(wasm::Store* store, const wasm::Module* module, int32_t n) {
+  auto imports = wasm::vec<wasm::Extern*>::make();
+  auto instance = wasm::Instance::make(store, module, imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+  auto export_ = instance->export_by_name("add");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(n), wasm::Val::i32(1));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (export_->func()->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != n + 1) {
+    std::cout << "> Error: " << n << " + 1 = " << results[0].i32() << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << n << " + 1 = " << results[0].i32() << std::endl;
+}
+
+auto compile(wasm::Store* store, const wasm::vec<byte_t>& binary)
+-> wasm::own<wasm::Module> {
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+  return module;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store1 = wasm::Store::make(engine.get());
+  auto store2 = wasm::Store::make(engine.get());
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("shared-code.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // A different binary with the same code, by appending a custom section.
+  const char custom[] = {0, 4, 3, 'x', 'y', 'z'};
+  auto binary2 =
+    wasm::vec<byte_t>::make_uninitialized(binary.size() + sizeof(custom));
+  std::memcpy(binary2.get(), binary.get(), binary.size());
+  std::memcpy(binary2.get() + binary.size(), custom, sizeof(custom));
+
+  // Compile the same binary in two stores, which share the code.
+  std::cout << "Compiling modules..." << std::endl;
+  auto module1 = compile(store1.get(), binary);
+  auto module2 = compile(store2.get(), binary);
+  auto module3 = compile(store2.get(), binary2);
+
+  // Check hashes.
+  std::cout << "Checking hashes..." << std::endl;
+  auto hash = module1->hash();
+  std::cout << "> " << std::hex << hash << std::dec << std::endl;
+  if (module2->hash() != hash) {
+    std::cout << "> Error: same binary has different hashes!" << std::endl;
+    exit(1);
+  }
+  if (module3->hash() == hash) {
+    std::cout << "> Error: different binaries have the same hash!" << std::endl;
+    exit(1);
+  }
+  auto copy = module1->copy();
+  auto deserialized = wasm::Module::deserialize(store1.get(), module1->serialize());
+  if (copy->hash() != hash || !deserialized || deserialized->hash() != hash) {
+    std::cout << "> Error: hash changed!" << std::endl;
+    exit(1);
+  }
+
+  // Shared code outlives the store that compiled it.
+  std::cout << "Deleting first store..." << std::endl;
+  check_module(store1.get(), module1.get(), 1);
+  copy.reset();
+  deserialized.reset();
+  module1.reset();
+  store1.reset();
+  check_module(store2.get(), module2.get(), 2);
+  check_module(store2.get(), module3.get(), 3);
+
+  // A new store picks up the code again.
+  std::cout << "Compiling in new store..." << std::endl;
+  auto store3 = wasm::Store::make(engine.get());
+  auto module4 = compile(store3.get(), binary);
+  if (module4->hash() != hash) {
+    std::cout << "> Error: same binary has different hashes!" << std::endl;
+    exit(1);
+  }
+  check_module(store3.get(), module4.get(), 4);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <unistd.h>
+
+#include "wasm.h"
+
+#define own
+
+// Only one engine can exist per process, so the snapshot is written to a
+// file and loaded by a second run of this program.
+const char* snapshot_file = "snapshot-c.data";
+
+
+// A function to be called from Wasm code.
+own wasm_trap_t* double_callback(
+  const wasm_val_vec_t* args, wasm_val_vec_t* results
+) {
+  printf("Calling back...\n");
+  results->data[0].kind = WASM_I32;
+  results->data[0].of.i32 = 2 * args->data[0].of.i32;
+  return NULL;
+}
+
+
+void load(const char* name, wasm_byte_vec_t* data) {
+  FILE* file = fopen(name, "rb");
+  if (!file) {
+    printf("> Error loading %s!\n", name);
+    exit(1);
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_new_uninitialized(data, file_size);
+  if (fread(data->data, file_size, 1, file) != 1) {
+    printf("> Error loading %s!\n", name);
+    exit(1);
+  }
+  fclose(file);
+}
+
+
+void make_snapshot() {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+
+  // Snapshot.
+  printf("Making snapshot...\n");
+  own wasm_byte_vec_t snapshot;
+  wasm_engine_make_snapshot(engine, &snapshot);
+  if (!snapshot.data || snapshot.size == 0) {
+    printf("> Error making snapshot!\n");
+    exit(1);
+  }
+  printf("> %zu bytes\n", snapshot.size);
+
+  FILE* file = fopen(snapshot_file, "wb");
+  if (!file || fwrite(snapshot.data, snapshot.size, 1, file) != 1) {
+    printf("> Error writing snapshot!\n");
+    exit(1);
+  }
+  fclose(file);
+  wasm_byte_vec_delete(&snapshot);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_engine_delete(engine);
+}
+
+
+void run_from_snapshot() {
+  // Initialize.
+  printf("Initializing from snapshot...\n");
+  own wasm_byte_vec_t snapshot;
+  load(snapshot_file, &snapshot);
+  remove(snapshot_file);
+  wasm_config_t* config = wasm_config_new();
+  wasm_config_set_snapshot(config, &snapshot);
+  wasm_engine_t* engine = wasm_engine_new_with_config(config);
+  wasm_store_t* store = wasm_store_new(engine);
+  if (!store) {
+    printf("> Error creating store!\n");
+    exit(1);
+  }
+
+  // Load binary.
+  printf("Loading binary...\n");
+  wasm_byte_vec_t binary;
+  load("snapshot.wasm", &binary);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    exit(1);
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create external function.
+  printf("Creating callback...\n");
+  own wasm_functype_t* double_type =
+    wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_func_t* double_func =
+    wasm_func_new(store, double_type, double_callback);
+
+  wasm_functype_delete(double_type);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_t* externs[] = { wasm_func_as_extern(double_func) };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    exit(1);
+  }
+
+  wasm_func_delete(double_func);
+
+  // Extract export.
+  printf("Extracting export...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  if (exports.size == 0) {
+    printf("> Error accessing exports!\n");
+    exit(1);
+  }
+  const wasm_func_t* run_func = wasm_extern_as_func(exports.data[0]);
+  if (run_func == NULL) {
+    printf("> Error accessing export!\n");
+    exit(1);
+  }
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call.
+  printf("Calling export...\n");
+  wasm_val_t as[1] = { WASM_I32_VAL(20) };
+  wasm_val_t rs[1] = { WASM_INIT_VAL };
+  wasm_val_vec_t args = WASM_ARRAY_VEC(as);
+  wasm_val_vec_t results = WASM_ARRAY_VEC(rs);
+  if (wasm_func_call(run_func, &args, &results)) {
+    printf("> Error calling function!\n");
+    exit(1);
+  }
+  if (rs[0].of.i32 != 41) {
+    printf("> Error: result %" PRIi32 ", expected 41!\n", rs[0].of.i32);
+    exit(1);
+  }
+  printf("> %" PRIi32 "\n", rs[0].of.i32);
+
+  wasm_extern_vec_delete(&exports);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+}
+
+
+int main(int argc, const char* argv[]) {
+  if (argc > 1) {
+    run_from_snapshot();
+    printf("Done.\n");
+    return 0;
+  }
+  make_snapshot();
+  printf("Restarting...\n");
+  fflush(stdout);
+  char* const args[] = {(char*)argv[0], "run", NULL};
+  execv(argv[0], args);
+  printf("> Error restarting!\n");
+  return 1;
+}
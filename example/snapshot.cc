@@ -0,0 +1,155 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <cinttypes>
+
+#include <unistd.h>
+
+#include "wasm.hh"
+
+// Only one engine can exist per process, so the snapshot is written to a
+// file and loaded by a second run of this program.
+const char* snapshot_file = "snapshot-cc.data";
+
+
+// A function to be called from Wasm code.
+auto double_callback(
+  const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  std::cout << "Calling back..." << std::endl;
+  results[0] = wasm::Val::i32(2 * args[0].i32());
+  return nullptr;
+}
+
+
+auto load(const char* name) -> wasm::vec<byte_t> {
+  std::ifstream file(name);
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto data = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(data.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading " << name << "!" << std::endl;
+    exit(1);
+  }
+  return data;
+}
+
+
+void make_snapshot() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+
+  // Snapshot.
+  std::cout << "Making snapshot..." << std::endl;
+  auto snapshot = engine->make_snapshot();
+  if (!snapshot || snapshot.size() == 0) {
+    std::cout << "> Error making snapshot!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << snapshot.size() << " bytes" << std::endl;
+
+  std::ofstream file(snapshot_file);
+  file.write(snapshot.get(), snapshot.size());
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error writing snapshot!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+void run_from_snapshot() {
+  // Initialize.
+  std::cout << "Initializing from snapshot..." << std::endl;
+  auto config = wasm::Config::make();
+  config->set_snapshot(load(snapshot_file));
+  std::remove(snapshot_file);
+  auto engine = wasm::Engine::make(std::move(config));
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+  if (!store) {
+    std::cout << "> Error creating store!" << std::endl;
+    exit(1);
+  }
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  auto binary = load("snapshot.wasm");
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create external function.
+  std::cout << "Creating callback..." << std::endl;
+  auto double_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32)),
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32))
+  );
+  auto double_func =
+    wasm::Func::make(store, double_type.get(), double_callback);
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(double_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  // Extract export.
+  std::cout << "Extracting export..." << std::endl;
+  auto export_ = instance->export_by_name("run");
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export!" << std::endl;
+    exit(1);
+  }
+  auto run_func = export_->func();
+
+  // Call.
+  std::cout << "Calling export..." << std::endl;
+  auto args = wasm::vec<wasm::Val>::make(wasm::Val::i32(20));
+  auto results = wasm::vec<wasm::Val>::make_uninitialized(1);
+  if (run_func->call(args, results)) {
+    std::cout << "> Error calling function!" << std::endl;
+    exit(1);
+  }
+  if (results[0].i32() != 41) {
+    std::cout << "> Error: result " << results[0].i32() << ", expected 41!"
+      << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << results[0].i32() << std::endl;
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  if (argc > 1) {
+    run_from_snapshot();
+    std::cout << "Done." << std::endl;
+    return 0;
+  }
+  make_snapshot();
+  std::cout << "Restarting..." << std::endl;
+  const char* args[] = {argv[0], "run", nullptr};
+  execv(argv[0], const_cast<char* const*>(args));
+  std::cout << "> Error restarting!" << std::endl;
+  return 1;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Raw slots hold the bits of a value, zero-extended to 64 bits.
+uint64_t slot_i32(int32_t x) { uint64_t s = 0; memcpy(&s, &x, 4); return s; }
+int32_t i32_slot(uint64_t s) { int32_t x; memcpy(&x, &s, 4); return x; }
+
+// Raw functions to be called from Wasm code. There is no typed variant in
+// the C API; raw callbacks take and return values in untagged slots.
+int mul_calls = 0;
+int check_calls = 0;
+
+own wasm_trap_t* mul_callback(void* env, uint64_t slots[]) {
+  ++mul_calls;
+  slots[0] = slot_i32(i32_slot(slots[0]) * i32_slot(slots[1]));
+  return NULL;
+}
+
+own wasm_trap_t* check_callback(void* env, uint64_t slots[]) {
+  ++check_calls;
+  if (i32_slot(slots[0]) < 0) {
+    own wasm_message_t message;
+    wasm_name_new_from_string_nt(&message, "negative");
+    own wasm_trap_t* trap = wasm_trap_new((wasm_store_t*)env, &message);
+    wasm_name_delete(&message);
+    return trap;
+  }
+  return NULL;
+}
+
+own wasm_trap_t* split_callback(void* env, uint64_t slots[]) {
+  int64_t x = (int64_t)slots[0];
+  slots[0] = slot_i32((int32_t)(x & 0xffffffff));
+  slots[1] = slot_i32((int32_t)(x >> 32));
+  return NULL;
+}
+
+
+const wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+void check_ok(const char* what, own wasm_trap_t* trap) {
+  if (trap) {
+    own wasm_message_t message;
+    wasm_trap_message(trap, &message);
+    printf("> Error: %s trapped: %s\n", what, message.data);
+    exit(1);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("typed-host.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create raw host functions.
+  printf("Creating callbacks...\n");
+  own wasm_functype_t* mul_type = wasm_functype_new_2_1(
+    wasm_valtype_new_i32(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_functype_t* check_type = wasm_functype_new_1_0(wasm_valtype_new_i32());
+  own wasm_functype_t* split_type = wasm_functype_new_1_2(
+    wasm_valtype_new_i64(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_func_t* mul_func =
+    wasm_func_new_raw(store, mul_type, mul_callback, NULL, NULL);
+  own wasm_func_t* check_func =
+    wasm_func_new_raw(store, check_type, check_callback, store, NULL);
+  own wasm_func_t* split_func =
+    wasm_func_new_raw(store, split_type, split_callback, NULL, NULL);
+  wasm_functype_delete(mul_type);
+  wasm_functype_delete(check_type);
+  wasm_functype_delete(split_type);
+  if (!mul_func || !check_func || !split_func) {
+    printf("> Error creating callbacks!\n");
+    return 1;
+  }
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_t* externs[] = {
+    wasm_func_as_extern(mul_func),
+    wasm_func_as_extern(check_func),
+    wasm_func_as_extern(split_func)
+  };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  const wasm_func_t* run_func = get_export_func(&exports, 0);
+  const wasm_func_t* split_export = get_export_func(&exports, 1);
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call through Wasm.
+  printf("Calling back...\n");
+  uint64_t slots[2];
+  slots[0] = slot_i32(6); slots[1] = slot_i32(7);
+  check_ok("run(6, 7)", wasm_func_call_raw(run_func, slots));
+  if (i32_slot(slots[0]) != 42) {
+    printf("> Error: run(6, 7) = %" PRIi32 "!\n", i32_slot(slots[0]));
+    return 1;
+  }
+  printf("> run(6, 7) = %" PRIi32 "\n", i32_slot(slots[0]));
+
+  slots[0] = (UINT64_C(5) << 32) | 7;
+  check_ok("split(5 << 32 | 7)", wasm_func_call_raw(split_export, slots));
+  if (i32_slot(slots[0]) != 7 || i32_slot(slots[1]) != 5) {
+    printf("> Error: split(5 << 32 | 7) = %" PRIi32 ", %" PRIi32 "!\n",
+      i32_slot(slots[0]), i32_slot(slots[1]));
+    return 1;
+  }
+  printf("> split(5 << 32 | 7) = %" PRIi32 ", %" PRIi32 "\n",
+    i32_slot(slots[0]), i32_slot(slots[1]));
+
+  // A trap raised by the callback stops the Wasm caller.
+  printf("Calling back with trap...\n");
+  slots[0] = slot_i32(-1); slots[1] = slot_i32(2);
+  own wasm_trap_t* trap = wasm_func_call_raw(run_func, slots);
+  if (!trap) {
+    printf("> Error: run(-1, 2) did not trap!\n");
+    return 1;
+  }
+  own wasm_message_t message;
+  wasm_trap_message(trap, &message);
+  printf("> run(-1, 2) trapped: %s\n", message.data);
+  wasm_byte_vec_delete(&message);
+  wasm_trap_delete(trap);
+  if (mul_calls != 1 || check_calls != 2) {
+    printf("> Error: %d mul and %d check callbacks, expected 1 and 2!\n",
+      mul_calls, check_calls);
+    return 1;
+  }
+
+  wasm_extern_vec_delete(&exports);
+  wasm_func_delete(mul_func);
+  wasm_func_delete(check_func);
+  wasm_func_delete(split_func);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
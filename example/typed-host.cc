@@ -0,0 +1,179 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+auto get_export_func(const wasm::Instance* instance, const char* name)
+-> wasm::own<wasm::Func> {
+  auto export_ = instance->export_by_name(name);
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export " << name << "!" << std::endl;
+    exit(1);
+  }
+  return export_->func()->copy();
+}
+
+void check_type(const char* name, const wasm::Func* func,
+  const wasm::ownvec<wasm::ValType>& params, const wasm::ownvec<wasm::ValType>& results
+) {
+  auto type = func->type();
+  auto equal = [](const wasm::ownvec<wasm::ValType>& a,
+                  const wasm::ownvec<wasm::ValType>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a[i]->kind() != b[i]->kind()) return false;
+    }
+    return true;
+  };
+  if (!type || !equal(type->params(), params) || !equal(type->results(), results)) {
+    std::cout << "> Error: wrong type for " << name << "!" << std::endl;
+    exit(1);
+  }
+}
+
+template<class T>
+void check(const char* what, const wasm::own<wasm::Trap>& trap, T result, T expected) {
+  if (trap) {
+    std::cout << "> Error: " << what << " trapped: " << trap->message().get()
+      << std::endl;
+    exit(1);
+  }
+  if (result != expected) {
+    std::cout << "> Error: " << what << " = " << result << ", expected "
+      << expected << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << what << " = " << result << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("typed-host.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create host functions from callables; their types follow the signature.
+  std::cout << "Creating callbacks..." << std::endl;
+  int mul_calls = 0;
+  int check_calls = 0;
+  auto mul_func = wasm::Func::make<int32_t(int32_t, int32_t)>(store,
+    [&mul_calls](int32_t x, int32_t y) { ++mul_calls; return x * y; });
+  auto check_func = wasm::Func::make<void(int32_t)>(store,
+    [store, &check_calls](int32_t x, wasm::own<wasm::Trap>* trap) {
+      ++check_calls;
+      if (x < 0) {
+        *trap = wasm::Trap::make(store, wasm::Message::make_nt(std::string("negative")));
+      }
+    });
+  auto split_func = wasm::Func::make<std::tuple<int32_t, int32_t>(int64_t)>(store,
+    [](int64_t x) {
+      return std::make_tuple(int32_t(x & 0xffffffff), int32_t(x >> 32));
+    });
+  if (!mul_func || !check_func || !split_func) {
+    std::cout << "> Error creating callbacks!" << std::endl;
+    exit(1);
+  }
+
+  auto i32 = []() { return wasm::ValType::make(wasm::ValKind::I32); };
+  auto i64 = []() { return wasm::ValType::make(wasm::ValKind::I64); };
+  check_type("mul", mul_func.get(),
+    wasm::ownvec<wasm::ValType>::make(i32(), i32()),
+    wasm::ownvec<wasm::ValType>::make(i32()));
+  check_type("check", check_func.get(),
+    wasm::ownvec<wasm::ValType>::make(i32()),
+    wasm::ownvec<wasm::ValType>::make());
+  check_type("split", split_func.get(),
+    wasm::ownvec<wasm::ValType>::make(i64()),
+    wasm::ownvec<wasm::ValType>::make(i32(), i32()));
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(
+    mul_func.get(), check_func.get(), split_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  auto run_func = get_export_func(instance.get(), "run");
+  auto split_export = get_export_func(instance.get(), "split");
+  auto run = wasm::TypedFunc<int32_t(int32_t, int32_t)>::bind(run_func.get());
+  auto split = wasm::TypedFunc<std::tuple<int32_t, int32_t>(int64_t)>::bind(
+    split_export.get());
+  if (!run || !split) {
+    std::cout << "> Error binding exports!" << std::endl;
+    exit(1);
+  }
+
+  // Call through Wasm.
+  std::cout << "Calling back..." << std::endl;
+  int32_t result = 0;
+  check("run(6, 7)", run.call(6, 7, &result), result, 42);
+  std::tuple<int32_t, int32_t> halves;
+  auto trap = split.call((int64_t(5) << 32) | 7, &halves);
+  check("split(5 << 32 | 7)[0]", trap, std::get<0>(halves), 7);
+  check("split(5 << 32 | 7)[1]", trap, std::get<1>(halves), 5);
+
+  // A trap raised by the callable stops the Wasm caller.
+  std::cout << "Calling back with trap..." << std::endl;
+  trap = run.call(-1, 2, &result);
+  if (!trap) {
+    std::cout << "> Error: run(-1, 2) did not trap!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> run(-1, 2) trapped: " << trap->message().get() << std::endl;
+  if (mul_calls != 1 || check_calls != 2) {
+    std::cout << "> Error: " << mul_calls << " mul and " << check_calls
+      << " check callbacks, expected 1 and 2!" << std::endl;
+    exit(1);
+  }
+
+  // Host functions can be called directly as well.
+  std::cout << "Calling directly..." << std::endl;
+  auto mul = wasm::TypedFunc<int32_t(int32_t, int32_t)>::bind(mul_func.get());
+  if (!mul) {
+    std::cout << "> Error binding mul!" << std::endl;
+    exit(1);
+  }
+  check("mul(-3, 5)", mul.call(-3, 5, &result), result, -15);
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,12 @@
+(module
+  (func $mul (import "" "mul") (param i32 i32) (result i32))
+  (func $check (import "" "check") (param i32))
+  (func $split (import "" "split") (param i64) (result i32 i32))
+  (func (export "run") (param i32 i32) (result i32)
+    (call $check (local.get 0))
+    (call $mul (local.get 0) (local.get 1))
+  )
+  (func (export "split") (param i64) (result i32 i32)
+    (call $split (local.get 0))
+  )
+)
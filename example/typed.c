@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "wasm.h"
+
+#define own
+
+// Raw slots hold the bits of a value, zero-extended to 64 bits.
+uint64_t slot_i32(int32_t x) { uint64_t s = 0; memcpy(&s, &x, 4); return s; }
+uint64_t slot_f64(double x) { uint64_t s = 0; memcpy(&s, &x, 8); return s; }
+int32_t i32_slot(uint64_t s) { int32_t x; memcpy(&x, &s, 4); return x; }
+double f64_slot(uint64_t s) { double x; memcpy(&x, &s, 8); return x; }
+
+// A raw function to be called from Wasm code, which traps on negative
+// arguments.
+int calls = 0;
+
+own wasm_trap_t* host_callback(void* env, uint64_t slots[]) {
+  ++calls;
+  int32_t x = i32_slot(slots[0]);
+  int32_t y = i32_slot(slots[1]);
+  if (x < 0) {
+    own wasm_message_t message;
+    wasm_name_new_from_string_nt(&message, "negative");
+    own wasm_trap_t* trap = wasm_trap_new((wasm_store_t*)env, &message);
+    wasm_name_delete(&message);
+    return trap;
+  }
+  slots[0] = slot_i32(x * y);
+  return NULL;
+}
+
+
+const wasm_func_t* get_export_func(const wasm_extern_vec_t* exports, size_t i) {
+  if (exports->size <= i || !wasm_extern_as_func(exports->data[i])) {
+    printf("> Error accessing function export %zu!\n", i);
+    exit(1);
+  }
+  return wasm_extern_as_func(exports->data[i]);
+}
+
+void check_ok(const char* what, own wasm_trap_t* trap) {
+  if (trap) {
+    own wasm_message_t message;
+    wasm_trap_message(trap, &message);
+    printf("> Error: %s trapped: %s\n", what, message.data);
+    exit(1);
+  }
+}
+
+void check_i32(const char* what, own wasm_trap_t* trap, int32_t result, int32_t expected) {
+  check_ok(what, trap);
+  if (result != expected) {
+    printf("> Error: %s = %" PRIi32 ", expected %" PRIi32 "!\n", what, result, expected);
+    exit(1);
+  }
+  printf("> %s = %" PRIi32 "\n", what, result);
+}
+
+void check_trap(const char* what, own wasm_trap_t* trap) {
+  if (!trap) {
+    printf("> Error: %s did not trap!\n", what);
+    exit(1);
+  }
+  own wasm_message_t message;
+  wasm_trap_message(trap, &message);
+  printf("> %s trapped: %s\n", what, message.data);
+  wasm_byte_vec_delete(&message);
+  wasm_trap_delete(trap);
+}
+
+
+int main(int argc, const char* argv[]) {
+  // Initialize.
+  printf("Initializing...\n");
+  wasm_engine_t* engine = wasm_engine_new();
+  wasm_store_t* store = wasm_store_new(engine);
+
+  // Load binary.
+  printf("Loading binary...\n");
+  FILE* file = fopen("typed.wasm", "rb");
+  if (!file) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fseek(file, 0L, SEEK_END);
+  size_t file_size = ftell(file);
+  fseek(file, 0L, SEEK_SET);
+  wasm_byte_vec_t binary;
+  wasm_byte_vec_new_uninitialized(&binary, file_size);
+  if (fread(binary.data, file_size, 1, file) != 1) {
+    printf("> Error loading module!\n");
+    return 1;
+  }
+  fclose(file);
+
+  // Compile.
+  printf("Compiling module...\n");
+  own wasm_module_t* module = wasm_module_new(store, &binary);
+  if (!module) {
+    printf("> Error compiling module!\n");
+    return 1;
+  }
+
+  wasm_byte_vec_delete(&binary);
+
+  // Create a raw host function.
+  printf("Creating callback...\n");
+  own wasm_functype_t* host_type = wasm_functype_new_2_1(
+    wasm_valtype_new_i32(), wasm_valtype_new_i32(), wasm_valtype_new_i32());
+  own wasm_func_t* host_func =
+    wasm_func_new_raw(store, host_type, host_callback, store, NULL);
+
+  wasm_functype_delete(host_type);
+
+  // Instantiate.
+  printf("Instantiating module...\n");
+  wasm_extern_t* externs[] = { wasm_func_as_extern(host_func) };
+  wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+  own wasm_instance_t* instance =
+    wasm_instance_new(store, module, &imports, NULL);
+  if (!instance) {
+    printf("> Error instantiating module!\n");
+    return 1;
+  }
+
+  // Extract exports.
+  printf("Extracting exports...\n");
+  own wasm_extern_vec_t exports;
+  wasm_instance_exports(instance, &exports);
+  const wasm_func_t* add_func = get_export_func(&exports, 0);
+  const wasm_func_t* div_func = get_export_func(&exports, 1);
+  const wasm_func_t* mul_func = get_export_func(&exports, 2);
+  const wasm_func_t* scale_func = get_export_func(&exports, 3);
+  const wasm_func_t* swap_func = get_export_func(&exports, 4);
+  const wasm_func_t* call_host_func = get_export_func(&exports, 5);
+
+  wasm_module_delete(module);
+  wasm_instance_delete(instance);
+
+  // Call through raw slots.
+  printf("Calling functions...\n");
+  uint64_t slots[2];
+  slots[0] = slot_i32(1); slots[1] = slot_i32(2);
+  check_i32("add(1, 2)", wasm_func_call_raw(add_func, slots), i32_slot(slots[0]), 3);
+  slots[0] = slot_i32(-1); slots[1] = slot_i32(1);
+  check_i32("add(-1, 1)", wasm_func_call_raw(add_func, slots), i32_slot(slots[0]), 0);
+  slots[0] = slot_i32(7); slots[1] = slot_i32(2);
+  check_i32("div(7, 2)", wasm_func_call_raw(div_func, slots), i32_slot(slots[0]), 3);
+
+  slots[0] = 3000000000; slots[1] = 3;
+  check_ok("mul(3e9, 3)", wasm_func_call_raw(mul_func, slots));
+  if (slots[0] != UINT64_C(9000000000)) {
+    printf("> Error: mul(3e9, 3) = %" PRIu64 "!\n", slots[0]);
+    return 1;
+  }
+  printf("> mul(3e9, 3) = %" PRIu64 "\n", slots[0]);
+
+  slots[0] = slot_f64(1.5); slots[1] = slot_f64(-2);
+  check_ok("scale(1.5, -2)", wasm_func_call_raw(scale_func, slots));
+  if (f64_slot(slots[0]) != -3.0) {
+    printf("> Error: scale(1.5, -2) = %g!\n", f64_slot(slots[0]));
+    return 1;
+  }
+  printf("> scale(1.5, -2) = %g\n", f64_slot(slots[0]));
+
+  slots[0] = slot_i32(7); slots[1] = UINT64_C(1) << 40;
+  check_ok("swap(7, 2^40)", wasm_func_call_raw(swap_func, slots));
+  if (slots[0] != UINT64_C(1) << 40 || i32_slot(slots[1]) != 7) {
+    printf("> Error: swap(7, 2^40) = %" PRIu64 ", %" PRIi32 "!\n",
+      slots[0], i32_slot(slots[1]));
+    return 1;
+  }
+  printf("> swap(7, 2^40) = %" PRIu64 ", %" PRIi32 "\n", slots[0], i32_slot(slots[1]));
+
+  // Traps leave the slots alone.
+  printf("Calling trapping functions...\n");
+  slots[0] = slot_i32(1); slots[1] = slot_i32(0);
+  check_trap("div(1, 0)", wasm_func_call_raw(div_func, slots));
+  if (i32_slot(slots[0]) != 1 || i32_slot(slots[1]) != 0) {
+    printf("> Error: trap overwrote slots!\n");
+    return 1;
+  }
+
+  // Host functions can be called through Wasm or directly.
+  printf("Calling back...\n");
+  slots[0] = slot_i32(3); slots[1] = slot_i32(4);
+  check_i32("call_host(3, 4)",
+    wasm_func_call_raw(call_host_func, slots), i32_slot(slots[0]), 12);
+  slots[0] = slot_i32(4); slots[1] = slot_i32(5);
+  check_i32("host(4, 5)",
+    wasm_func_call_raw(host_func, slots), i32_slot(slots[0]), 20);
+  slots[0] = slot_i32(-1); slots[1] = slot_i32(4);
+  check_trap("call_host(-1, 4)", wasm_func_call_raw(call_host_func, slots));
+  slots[0] = slot_i32(-1); slots[1] = slot_i32(4);
+  check_trap("host(-1, 4)", wasm_func_call_raw(host_func, slots));
+  if (calls != 4) {
+    printf("> Error: %d callbacks, expected 4!\n", calls);
+    return 1;
+  }
+
+  wasm_extern_vec_delete(&exports);
+  wasm_func_delete(host_func);
+
+  // Shut down.
+  printf("Shutting down...\n");
+  wasm_store_delete(store);
+  wasm_engine_delete(engine);
+
+  // All done.
+  printf("Done.\n");
+  return 0;
+}
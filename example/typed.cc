@@ -0,0 +1,196 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <cinttypes>
+
+#include "wasm.hh"
+
+
+auto get_export_func(const wasm::Instance* instance, const char* name)
+-> wasm::own<wasm::Func> {
+  auto export_ = instance->export_by_name(name);
+  if (!export_ || !export_->func()) {
+    std::cout << "> Error accessing export " << name << "!" << std::endl;
+    exit(1);
+  }
+  return export_->func()->copy();
+}
+
+// A function to be called from Wasm code, which traps on negative arguments.
+int calls = 0;
+
+auto host_callback(
+  void* env, const wasm::vec<wasm::Val>& args, wasm::vec<wasm::Val>& results
+) -> wasm::own<wasm::Trap> {
+  ++calls;
+  if (args[0].i32() < 0) {
+    auto store = static_cast<wasm::Store*>(env);
+    return wasm::Trap::make(store, wasm::Message::make_nt(std::string("negative")));
+  }
+  results[0] = wasm::Val::i32(args[0].i32() * args[1].i32());
+  return nullptr;
+}
+
+
+template<class Sig>
+auto bind(const wasm::Func* func, const char* name) -> wasm::TypedFunc<Sig> {
+  auto typed = wasm::TypedFunc<Sig>::bind(func);
+  if (!typed) {
+    std::cout << "> Error binding " << name << "!" << std::endl;
+    exit(1);
+  }
+  return typed;
+}
+
+template<class T>
+void check(const char* what, const wasm::own<wasm::Trap>& trap, T result, T expected) {
+  if (trap) {
+    std::cout << "> Error: " << what << " trapped: " << trap->message().get()
+      << std::endl;
+    exit(1);
+  }
+  if (result != expected) {
+    std::cout << "> Error: " << what << " = " << result << ", expected "
+      << expected << "!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << what << " = " << result << std::endl;
+}
+
+void check_trap(const char* what, const wasm::own<wasm::Trap>& trap) {
+  if (!trap) {
+    std::cout << "> Error: " << what << " did not trap!" << std::endl;
+    exit(1);
+  }
+  std::cout << "> " << what << " trapped: " << trap->message().get() << std::endl;
+}
+
+
+void run() {
+  // Initialize.
+  std::cout << "Initializing..." << std::endl;
+  auto engine = wasm::Engine::make();
+  auto store_ = wasm::Store::make(engine.get());
+  auto store = store_.get();
+
+  // Load binary.
+  std::cout << "Loading binary..." << std::endl;
+  std::ifstream file("typed.wasm");
+  file.seekg(0, std::ios_base::end);
+  auto file_size = file.tellg();
+  file.seekg(0);
+  auto binary = wasm::vec<byte_t>::make_uninitialized(file_size);
+  file.read(binary.get(), file_size);
+  file.close();
+  if (file.fail()) {
+    std::cout << "> Error loading module!" << std::endl;
+    exit(1);
+  }
+
+  // Compile.
+  std::cout << "Compiling module..." << std::endl;
+  auto module = wasm::Module::make(store, binary);
+  if (!module) {
+    std::cout << "> Error compiling module!" << std::endl;
+    exit(1);
+  }
+
+  // Create a host function, which traps on negative arguments.
+  std::cout << "Creating callback..." << std::endl;
+  auto host_type = wasm::FuncType::make(
+    wasm::ownvec<wasm::ValType>::make(
+      wasm::ValType::make(wasm::ValKind::I32), wasm::ValType::make(wasm::ValKind::I32)),
+    wasm::ownvec<wasm::ValType>::make(wasm::ValType::make(wasm::ValKind::I32))
+  );
+  auto host_func = wasm::Func::make(store, host_type.get(), host_callback, store);
+  if (!host_func) {
+    std::cout << "> Error creating callback!" << std::endl;
+    exit(1);
+  }
+
+  // Instantiate.
+  std::cout << "Instantiating module..." << std::endl;
+  auto imports = wasm::vec<wasm::Extern*>::make(host_func.get());
+  auto instance = wasm::Instance::make(store, module.get(), imports);
+  if (!instance) {
+    std::cout << "> Error instantiating module!" << std::endl;
+    exit(1);
+  }
+
+  auto add_func = get_export_func(instance.get(), "add");
+  auto div_func = get_export_func(instance.get(), "div");
+  auto mul_func = get_export_func(instance.get(), "mul");
+  auto scale_func = get_export_func(instance.get(), "scale");
+  auto swap_func = get_export_func(instance.get(), "swap");
+  auto call_host_func = get_export_func(instance.get(), "call_host");
+
+  // Binding checks the signature.
+  std::cout << "Binding functions..." << std::endl;
+  if (wasm::TypedFunc<int64_t(int64_t, int64_t)>::bind(add_func.get()) ||
+      wasm::TypedFunc<void(int32_t, int32_t)>::bind(add_func.get()) ||
+      wasm::TypedFunc<int32_t(int32_t)>::bind(add_func.get()) ||
+      wasm::TypedFunc<int32_t(int32_t, int32_t)>::bind(nullptr)) {
+    std::cout << "> Error: bound function with wrong signature!" << std::endl;
+    exit(1);
+  }
+  auto add = bind<int32_t(int32_t, int32_t)>(add_func.get(), "add");
+  auto div = bind<int32_t(int32_t, int32_t)>(div_func.get(), "div");
+  auto mul = bind<int64_t(int64_t, int64_t)>(mul_func.get(), "mul");
+  auto scale = bind<double(double, double)>(scale_func.get(), "scale");
+  auto swap = bind<std::tuple<int64_t, int32_t>(int32_t, int64_t)>(
+    swap_func.get(), "swap");
+  auto call_host = bind<int32_t(int32_t, int32_t)>(
+    call_host_func.get(), "call_host");
+  auto host = bind<int32_t(int32_t, int32_t)>(host_func.get(), "host");
+
+  // Call.
+  std::cout << "Calling functions..." << std::endl;
+  int32_t i32 = 0;
+  int64_t i64 = 0;
+  double f64 = 0;
+  check("add(1, 2)", add.call(1, 2, &i32), i32, 3);
+  check("add(-1, 1)", add.call(-1, 1, &i32), i32, 0);
+  check("div(7, 2)", div.call(7, 2, &i32), i32, 3);
+  check("mul(3e9, 3)", mul.call(3000000000, 3, &i64), i64, int64_t(9000000000));
+  check("scale(1.5, -2)", scale.call(1.5, -2, &f64), f64, -3.0);
+  std::tuple<int64_t, int32_t> pair;
+  auto trap = swap.call(7, int64_t(1) << 40, &pair);
+  check("swap(7, 2^40)[0]", trap, std::get<0>(pair), int64_t(1) << 40);
+  check("swap(7, 2^40)[1]", trap, std::get<1>(pair), 7);
+  if (add.call(5, 6)) {
+    std::cout << "> Error: add(5, 6) without result trapped!" << std::endl;
+    exit(1);
+  }
+
+  // Traps leave the results alone.
+  std::cout << "Calling trapping functions..." << std::endl;
+  i32 = 42;
+  check_trap("div(1, 0)", div.call(1, 0, &i32));
+  if (i32 != 42) {
+    std::cout << "> Error: trap overwrote result!" << std::endl;
+    exit(1);
+  }
+
+  // Host functions can be called through Wasm or directly.
+  std::cout << "Calling back..." << std::endl;
+  check("call_host(3, 4)", call_host.call(3, 4, &i32), i32, 12);
+  check("host(4, 5)", host.call(4, 5, &i32), i32, 20);
+  check_trap("call_host(-1, 4)", call_host.call(-1, 4, &i32));
+  check_trap("host(-1, 4)", host.call(-1, 4, &i32));
+  if (calls != 4) {
+    std::cout << "> Error: " << calls << " callbacks, expected 4!" << std::endl;
+    exit(1);
+  }
+
+  // Shut down.
+  std::cout << "Shutting down..." << std::endl;
+}
+
+
+int main(int argc, const char* argv[]) {
+  run();
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -128,6 +128,9 @@ WASM_API_EXTERN own wasm_config_t* wasm_config_new(void);
 
 // Embedders may provide custom functions for manipulating configs.
 
+WASM_API_EXTERN void wasm_config_set_code_cache_dir(wasm_config_t*, const char* dir);
+WASM_API_EXTERN void wasm_config_set_snapshot(wasm_config_t*, own wasm_byte_vec_t* snapshot);
+
 
 // Engine
 
@@ -136,6 +139,8 @@ WASM_DECLARE_OWN(engine)
 WASM_API_EXTERN own wasm_engine_t* wasm_engine_new(void);
 WASM_API_EXTERN own wasm_engine_t* wasm_engine_new_with_config(own wasm_config_t*);
 
+WASM_API_EXTERN void wasm_engine_make_snapshot(const wasm_engine_t*, own wasm_byte_vec_t* out);
+
 
 // Store
 
@@ -143,6 +148,22 @@ WASM_DECLARE_OWN(store)
 
 WASM_API_EXTERN own wasm_store_t* wasm_store_new(wasm_engine_t*);
 
+WASM_API_EXTERN size_t wasm_store_wrapper_cache_hits(const wasm_store_t*);
+WASM_API_EXTERN size_t wasm_store_wrapper_cache_misses(const wasm_store_t*);
+WASM_API_EXTERN size_t wasm_store_run_pending(wasm_store_t*, bool wait);
+WASM_API_EXTERN bool wasm_store_reset(wasm_store_t*);
+
+
+// Store pools
+
+WASM_DECLARE_OWN(store_pool)
+
+WASM_API_EXTERN own wasm_store_pool_t* wasm_store_pool_new(
+  wasm_engine_t*, size_t capacity, size_t warm);
+WASM_API_EXTERN own wasm_store_t* wasm_store_pool_acquire(wasm_store_pool_t*);
+WASM_API_EXTERN void wasm_store_pool_release(wasm_store_pool_t*, own wasm_store_t*);
+WASM_API_EXTERN size_t wasm_store_pool_idle_count(const wasm_store_pool_t*);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -402,12 +423,44 @@ WASM_API_EXTERN own wasm_module_t* wasm_module_new(
 
 WASM_API_EXTERN bool wasm_module_validate(wasm_store_t*, const wasm_byte_vec_t* binary);
 
+typedef void (*wasm_module_callback_t)(void* env, own wasm_module_t*);
+
+WASM_API_EXTERN void wasm_module_new_async(
+  wasm_store_t*, own wasm_byte_vec_t* binary, wasm_module_callback_t, void* env);
+
+typedef struct wasm_module_bulk_item_t {
+  const wasm_byte_vec_t* bytes;
+  bool serialized;
+  own wasm_module_t* module;
+  uint64_t time_ns;
+} wasm_module_bulk_item_t;
+
+// See Module::make_many; serialized items are deserialized sequentially.
+WASM_API_EXTERN uint64_t wasm_module_new_many(
+  wasm_store_t*, size_t, wasm_module_bulk_item_t items[], size_t max_parallel);
+
 WASM_API_EXTERN void wasm_module_imports(const wasm_module_t*, own wasm_importtype_vec_t* out);
 WASM_API_EXTERN void wasm_module_exports(const wasm_module_t*, own wasm_exporttype_vec_t* out);
+WASM_API_EXTERN uint64_t wasm_module_hash(const wasm_module_t*);
 
 WASM_API_EXTERN void wasm_module_serialize(const wasm_module_t*, own wasm_byte_vec_t* out);
 WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize(wasm_store_t*, const wasm_byte_vec_t*);
 
+typedef bool (*wasm_module_writer_t)(void* env, const wasm_byte_t* data, size_t size);
+typedef size_t (*wasm_module_reader_t)(void* env, wasm_byte_t* data, size_t size);
+
+WASM_API_EXTERN bool wasm_module_serialize_to(const wasm_module_t*, wasm_module_writer_t, void* env);
+WASM_API_EXTERN bool wasm_module_serialize_to_fd(const wasm_module_t*, int fd);
+WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize_from(
+  wasm_store_t*, wasm_module_reader_t, void* env);
+
+WASM_DECLARE_OWN(module_streamer)
+
+WASM_API_EXTERN own wasm_module_streamer_t* wasm_module_streamer_new(wasm_store_t*);
+WASM_API_EXTERN void wasm_module_streamer_feed(
+  wasm_module_streamer_t*, const wasm_byte_vec_t* chunk);
+WASM_API_EXTERN own wasm_module_t* wasm_module_streamer_finish(wasm_module_streamer_t*);
+
 
 // Function Instances
 
@@ -417,12 +470,28 @@ typedef own wasm_trap_t* (*wasm_func_callback_t)(
   const wasm_val_vec_t* args, own wasm_val_vec_t* results);
 typedef own wasm_trap_t* (*wasm_func_callback_with_env_t)(
   void* env, const wasm_val_vec_t* args, wasm_val_vec_t* results);
+typedef own wasm_trap_t* (*wasm_func_callback_raw_t)(
+  void* env, uint64_t slots[]);
 
 WASM_API_EXTERN own wasm_func_t* wasm_func_new(
   wasm_store_t*, const wasm_functype_t*, wasm_func_callback_t);
 WASM_API_EXTERN own wasm_func_t* wasm_func_new_with_env(
   wasm_store_t*, const wasm_functype_t* type, wasm_func_callback_with_env_t,
   void* env, void (*finalizer)(void*));
+WASM_API_EXTERN own wasm_func_t* wasm_func_new_raw(
+  wasm_store_t*, const wasm_functype_t* type, wasm_func_callback_raw_t,
+  void* env, void (*finalizer)(void*));
+
+typedef struct wasm_func_def_t {
+  const wasm_functype_t* type;
+  wasm_func_callback_with_env_t callback;
+  void* env;
+  void (*finalizer)(void*);
+} wasm_func_def_t;
+
+// Creates all functions or none; on failure, all of out is null.
+WASM_API_EXTERN void wasm_func_new_many(
+  wasm_store_t*, size_t, const wasm_func_def_t defs[], own wasm_func_t* out[]);
 
 WASM_API_EXTERN own wasm_functype_t* wasm_func_type(const wasm_func_t*);
 WASM_API_EXTERN size_t wasm_func_param_arity(const wasm_func_t*);
@@ -430,6 +499,30 @@ WASM_API_EXTERN size_t wasm_func_result_arity(const wasm_func_t*);
 
 WASM_API_EXTERN own wasm_trap_t* wasm_func_call(
   const wasm_func_t*, const wasm_val_vec_t* args, wasm_val_vec_t* results);
+WASM_API_EXTERN own wasm_trap_t* wasm_func_call_unchecked(
+  const wasm_func_t*, const wasm_val_t args[], own wasm_val_t results[]);
+WASM_API_EXTERN own wasm_trap_t* wasm_func_call_raw(
+  const wasm_func_t*, uint64_t slots[]);
+typedef void (*wasm_func_async_callback_t)(
+  void* env, const wasm_val_vec_t* results, const wasm_message_t* trap);
+
+// Must be called on the store's thread; see Func::call_async.
+WASM_API_EXTERN void wasm_func_call_async(
+  wasm_store_t*, const wasm_func_t*, own wasm_val_vec_t* args,
+  wasm_func_async_callback_t, void* env);
+
+typedef struct wasm_column_t {
+  wasm_valkind_t kind;
+  void* data;
+} wasm_column_t;
+
+WASM_API_EXTERN size_t wasm_func_call_columns(
+  const wasm_func_t*, size_t n,
+  const wasm_column_t params[], const wasm_column_t results[],
+  own wasm_trap_t** first_trap);
+WASM_API_EXTERN size_t wasm_func_call_batch(
+  const wasm_func_t*, size_t n, const wasm_val_t args[], own wasm_val_t results[],
+  own wasm_trap_t** first_trap);
 
 
 // Global Instances
@@ -521,6 +614,28 @@ WASM_API_EXTERN own wasm_instance_t* wasm_instance_new(
 );
 
 WASM_API_EXTERN void wasm_instance_exports(const wasm_instance_t*, own wasm_extern_vec_t* out);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t*, const wasm_name_t* name);
+WASM_API_EXTERN own wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t*, size_t index);
+
+
+// Linking
+
+WASM_DECLARE_OWN(linker)
+WASM_DECLARE_OWN(instance_pre)
+
+WASM_API_EXTERN own wasm_linker_t* wasm_linker_new(wasm_store_t*);
+WASM_API_EXTERN bool wasm_linker_define(
+  wasm_linker_t*, const wasm_name_t* module, const wasm_name_t* name,
+  const wasm_extern_t*);
+WASM_API_EXTERN own wasm_instance_pre_t* wasm_linker_resolve(
+  const wasm_linker_t*, const wasm_module_t*, own wasm_trap_t**);
+WASM_API_EXTERN own wasm_instance_t* wasm_linker_instantiate(
+  const wasm_linker_t*, const wasm_module_t*, own wasm_trap_t**);
+
+WASM_API_EXTERN own wasm_instance_t* wasm_instance_pre_instantiate(
+  const wasm_instance_pre_t*, own wasm_trap_t**);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -7,10 +7,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <future>
 #include <memory>
 #include <new>
 #include <limits>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #ifndef WASM_API_EXTERN
 #if defined(_WIN32) && !defined(__MINGW32__) && !defined(LIBWASM_STATIC)
@@ -213,6 +217,17 @@ public:
   static auto make() -> own<Config>;
 
   // Implementations may provide custom methods for manipulating Configs.
+
+  // Caches compiled modules as files in the given directory, which must
+  // exist, keyed by their binary and the engine version and flags.
+  // Module::make then loads modules compiled before from there. Entries are
+  // written in the background once the code is optimized, and destroying
+  // the engine waits for pending writes.
+  void set_code_cache_dir(const std::string& dir);
+
+  // Creates stores from a snapshot made by Engine::make_snapshot, which
+  // must come from the same build of the engine; otherwise it is ignored.
+  void set_snapshot(vec<byte_t>&& snapshot);
 };
 
 
@@ -228,6 +243,10 @@ protected:
 
 public:
   static auto make(own<Config>&& = Config::make()) -> own<Engine>;
+
+  // Serializes a store's initial state, for use with Config::set_snapshot
+  // in later processes. Returns an invalid vector on failure.
+  auto make_snapshot() const -> vec<byte_t>;
 };
 
 
@@ -243,6 +262,49 @@ protected:
 
 public:
   static auto make(Engine*) -> own<Store>;
+
+  // Host globals are backed by auxiliary modules, compiled once per type.
+  auto wrapper_cache_hits() const -> size_t;
+  auto wrapper_cache_misses() const -> size_t;
+
+  // Delivers completed asynchronous work on the calling thread, which must
+  // own the store: calls queued by Func::call_async and compilations from
+  // Module::make_async. With wait, first blocks until there is work.
+  // Returns the number of completions delivered.
+  auto run_pending(bool wait = false) -> size_t;
+
+  // Returns the store to a clean state while keeping its isolate, context,
+  // and caches. All references into the store, instance templates, and
+  // module streamers must have been destroyed, since reset only collects
+  // garbage and frees nothing still referenced; otherwise the store is left
+  // untouched and false is returned. Pending asynchronous calls are cancelled.
+  auto reset() -> bool;
+};
+
+
+// Store pools
+
+// Keeps reset stores around for reuse, since creating a store is expensive.
+// Stores are bound to the thread that created them, so pools are as well.
+class WASM_API_EXTERN StorePool {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  StorePool() = default;
+  ~StorePool() = default;
+
+public:
+  // Keeps at most capacity idle stores, of which warm are created upfront.
+  static auto make(Engine*, size_t capacity, size_t warm = 0) -> own<StorePool>;
+
+  // Takes an idle store, or creates a new one if there is none.
+  auto acquire() -> own<Store>;
+  // Resets the store and keeps it if there is capacity, or deletes it.
+  // All references into the store must have been destroyed, as for deleting
+  // it; should any still be live, the store is deleted rather than reused.
+  void release(own<Store>&&);
+  auto idle_count() const -> size_t;
 };
 
 
@@ -588,6 +650,48 @@ template<> inline auto Val::get<uint64_t>() const -> uint64_t {
 }
 
 
+// Raw Values
+
+// Untagged 64-bit slots, as used by raw callbacks. Numbers are stored by
+// bit pattern, 32-bit values zero-extended in the low half.
+
+template<class T> inline auto raw_encode(T x) -> uint64_t {
+  static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "numeric type");
+  uint64_t raw = 0;
+  std::memcpy(&raw, &x, sizeof(T));
+  return raw;
+}
+
+template<class T> inline auto raw_decode(uint64_t raw) -> T {
+  static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "numeric type");
+  T x;
+  std::memcpy(&x, &raw, sizeof(T));
+  return x;
+}
+
+template<class T> struct raw_kind;
+template<> struct raw_kind<int32_t> { static constexpr ValKind kind = ValKind::I32; };
+template<> struct raw_kind<uint32_t> { static constexpr ValKind kind = ValKind::I32; };
+template<> struct raw_kind<int64_t> { static constexpr ValKind kind = ValKind::I64; };
+template<> struct raw_kind<uint64_t> { static constexpr ValKind kind = ValKind::I64; };
+template<> struct raw_kind<float32_t> { static constexpr ValKind kind = ValKind::F32; };
+template<> struct raw_kind<float64_t> { static constexpr ValKind kind = ValKind::F64; };
+
+
+// Columns
+
+// A typed contiguous array holding one value per call, for columnar calls.
+
+struct Column {
+  ValKind kind;
+  void* data;
+
+  template<class T> static auto of(const T* data) -> Column {
+    return Column{raw_kind<T>::kind, const_cast<T*>(data)};
+  }
+};
+
+
 // Traps
 
 using Message = vec<byte_t>;  // null terminated
@@ -644,16 +748,53 @@ protected:
 public:
   static auto validate(Store*, const vec<byte_t>& binary) -> bool;
   static auto make(Store*, const vec<byte_t>& binary) -> own<Module>;
+  // Compiles on background threads without blocking the store. The callback
+  // is invoked on the store's thread from Store::run_pending, with null if
+  // compilation failed or the store is deleted first. If compilation cannot
+  // be started for lack of memory, the callback is invoked right away.
+  using compile_callback = void (*)(void*, own<Module>&&);
+  static void make_async(
+    Store*, vec<byte_t>&& binary, compile_callback, void* env);
+  // Creates many modules at once. Compilation is spread over the platform's
+  // worker threads, with at most max_parallel modules in flight (0 for one
+  // per worker). Serialized items are not parallelized: V8 deserializes only
+  // on the isolate's thread, so they are deserialized one after another on
+  // this thread while compilations run in the background. Identical
+  // binaries are compiled once. Returns the total time taken, in
+  // nanoseconds.
+  struct BulkItem {
+    const vec<byte_t>* bytes;
+    bool serialized;     // bytes are the result of serialize()
+    own<Module> module;  // null if the item failed
+    uint64_t time_ns;    // from starting the item until it was done
+  };
+  static auto make_many(
+    Store*, size_t, BulkItem[], size_t max_parallel = 0) -> uint64_t;
   auto copy() const -> own<Module>;
 
   auto imports() const -> ownvec<ImportType>;
   auto exports() const -> ownvec<ExportType>;
 
+  // A fast, non-cryptographic hash of the module's binary. Module::make
+  // reuses the code of modules with identical binaries across stores.
+  auto hash() const -> uint64_t;
+
   auto share() const -> own<Shared<Module>>;
   static auto obtain(Store*, const Shared<Module>*) -> own<Module>;
 
   auto serialize() const -> vec<byte_t>;
   static auto deserialize(Store*, const vec<byte_t>&) -> own<Module>;
+
+  // Produce and consume the same format as serialize/deserialize, but pass
+  // it through in pieces instead of a single buffer. A writer returns false
+  // to abort; a reader returns the number of bytes read, 0 at the end.
+  // Serializing to a regular file opened for reading and writing generates
+  // the code directly into the file, starting at its current position.
+  using writer = bool (*)(void*, const byte_t*, size_t);
+  using reader = size_t (*)(void*, byte_t*, size_t);
+  auto serialize_to(writer, void* env) const -> bool;
+  auto serialize_to_fd(int fd) const -> bool;
+  static auto deserialize_from(Store*, reader, void* env) -> own<Module>;
 };
 
 
@@ -670,6 +811,31 @@ protected:
 };
 
 
+// Streaming compilation
+
+// Compiles a module from bytes arriving in chunks. Function bodies are
+// compiled in the background as soon as they have been fed.
+
+class WASM_API_EXTERN ModuleStreamer {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  ModuleStreamer() = default;
+  ~ModuleStreamer() = default;
+
+public:
+  static auto make(Store*) -> own<ModuleStreamer>;
+
+  void feed(const byte_t* data, size_t size);
+  void feed(const vec<byte_t>& chunk) { feed(chunk.get(), chunk.size()); }
+
+  // Waits for compilation to complete, returning null if the bytes fed do
+  // not form a valid module. The streamer cannot be fed afterwards.
+  auto finish() -> own<Module>;
+};
+
+
 // Foreign Objects
 
 class WASM_API_EXTERN Foreign : public Ref {
@@ -732,10 +898,42 @@ protected:
 public:
   using callback = auto (*)(const vec<Val>&, vec<Val>&) -> own<Trap>;
   using callback_with_env = auto (*)(void*, const vec<Val>&, vec<Val>&) -> own<Trap>;
+  // Raw callbacks receive the arguments as untagged slots (see raw_encode)
+  // and write their results back into the same array, which has room for
+  // max(params, results) slots. Only numeric signatures are supported.
+  using callback_raw = auto (*)(void*, uint64_t[]) -> own<Trap>;
 
+  // These return null on failure, without calling the finalizer; the env
+  // then still belongs to the caller. Once V8 owns it, they cannot fail.
   static auto make(Store*, const FuncType*, callback) -> own<Func>;
   static auto make(Store*, const FuncType*, callback_with_env,
     void*, void (*finalizer)(void*) = nullptr) -> own<Func>;
+  static auto make_raw(Store*, const FuncType*, callback_raw,
+    void*, void (*finalizer)(void*) = nullptr) -> own<Func>;
+
+  struct Def {
+    const FuncType* type;
+    callback_with_env callback;
+    void* env;
+    void (*finalizer)(void*);
+  };
+  // Creates all functions or none; returns an invalid vector on failure,
+  // without calling any finalizer.
+  static auto make_many(Store*, size_t, const Def[]) -> ownvec<Func>;
+  // Creates a host function with numeric signature Sig from a callable,
+  // see Typed Host Functions below.
+  template<class Sig, class F>
+  static auto make(Store*, F&& callable) -> own<Func>;
+
+  // Outcome of an asynchronous call. Traps are reported by message only,
+  // so that results can be consumed off the store's thread; the message
+  // is invalid if the call did not trap.
+  struct CallResult {
+    vec<Val> results;
+    Message trap;
+  };
+  using async_callback = void (*)(void*, CallResult&);
+
   auto copy() const -> own<Func>;
 
   auto type() const -> own<FuncType>;
@@ -743,8 +941,272 @@ public:
   auto result_arity() const -> size_t;
 
   auto call(const vec<Val>&, vec<Val>&) const -> own<Trap>;
+  // Argument kinds are not checked, not even in debug builds.
+  auto call_unchecked(const Val args[], Val results[]) const -> own<Trap>;
+  // Takes arguments and returns results in untagged slots, like raw
+  // callbacks. Only numeric signatures are supported.
+  auto call_raw(uint64_t slots[]) const -> own<Trap>;
+  // Signature and call target of a function with numeric signature,
+  // resolved once by prepare_raw for repeated raw calls. The fields are
+  // opaque, and the target is only valid while the function is alive.
+  struct RawTarget {
+    const void* sig = nullptr;
+    void* data = nullptr;
+    int kind = 0;
+
+    explicit operator bool() const { return sig != nullptr; }
+  };
+  // Returns an invalid target if the signature is not numeric.
+  auto prepare_raw() const -> RawTarget;
+  auto call_raw(const RawTarget&, uint64_t slots[]) const -> own<Trap>;
+  // Calls the function n times, with consecutive argument and result
+  // arrays of the function's arity. Stops at the first trap, storing it in
+  // *first_trap, and returns the number of calls that completed.
+  auto call_batch(size_t n, const Val args[], Val results[],
+    own<Trap>* first_trap = nullptr) const -> size_t;
+  // Like call_batch, but takes one column per parameter and result. The
+  // column kinds must match the signature, which must be numeric.
+  auto call_columns(size_t n, const Column params[], const Column results[],
+    own<Trap>* first_trap = nullptr) const -> size_t;
+  // Queues a call to be run by the store's owning thread in
+  // Store::run_pending. The call holds its own copy of the function, which
+  // is made here, so these must be called on the store's thread. Only
+  // numeric arguments and results are supported; other calls complete
+  // with a trap. Returns an invalid future if out of memory.
+  auto call_async(Store*, vec<Val>&& args) const -> std::future<CallResult>;
+  // Like above, but invokes the callback on the store's thread instead.
+  // If the call cannot be queued, the callback is invoked right away.
+  void call_async(Store*, vec<Val>&& args, async_callback, void*) const;
+  // Like above, but take the function, and may be called from any thread.
+  static auto call_async(own<Func>&&, Store*, vec<Val>&& args)
+    -> std::future<CallResult>;
+  static void call_async(own<Func>&&, Store*, vec<Val>&& args,
+    async_callback, void*);
+};
+
+
+// Typed Function Handles
+
+// Statically typed view of a function with a numeric signature. The
+// signature is checked and the call target resolved once, when binding;
+// calls then pass their arguments through raw slots. Multiple results are
+// returned as a std::tuple.
+//
+//   auto add = TypedFunc<int32_t(int32_t, int32_t)>::bind(func);
+//   int32_t sum;
+//   if (add && !add.call(1, 2, &sum)) ...
+
+// Index sequences, since std::index_sequence is not available in C++11.
+template<size_t... Is> struct index_seq {};
+template<size_t N, size_t... Is>
+struct make_index_seq : make_index_seq<N - 1, N - 1, Is...> {};
+template<size_t... Is>
+struct make_index_seq<0, Is...> { using type = index_seq<Is...>; };
+
+template<class... Ts>
+inline auto raw_kinds_match(const ownvec<ValType>& types) -> bool {
+  constexpr ValKind kinds[] = {raw_kind<Ts>::kind..., ValKind::I32};
+  if (types.size() != sizeof...(Ts)) return false;
+  for (size_t i = 0; i < sizeof...(Ts); ++i) {
+    if (types[i]->kind() != kinds[i]) return false;
+  }
+  return true;
+}
+
+template<class R> struct raw_results {
+  static constexpr size_t arity = 1;
+  static auto types() -> ownvec<ValType> {
+    return ownvec<ValType>::make(ValType::make(raw_kind<R>::kind));
+  }
+  static auto match(const ownvec<ValType>& types) -> bool {
+    return raw_kinds_match<R>(types);
+  }
+  static void encode(uint64_t slots[], const R& result) {
+    slots[0] = raw_encode(result);
+  }
+  static void decode(const uint64_t slots[], R* result) {
+    *result = raw_decode<R>(slots[0]);
+  }
+};
+
+template<> struct raw_results<void> {
+  static constexpr size_t arity = 0;
+  static auto types() -> ownvec<ValType> {
+    return ownvec<ValType>::make();
+  }
+  static auto match(const ownvec<ValType>& types) -> bool {
+    return types.size() == 0;
+  }
+  static void decode(const uint64_t[], void*) {}
+};
+
+template<class... Rs> struct raw_results<std::tuple<Rs...>> {
+  static constexpr size_t arity = sizeof...(Rs);
+  static auto types() -> ownvec<ValType> {
+    return ownvec<ValType>::make(ValType::make(raw_kind<Rs>::kind)...);
+  }
+  static auto match(const ownvec<ValType>& types) -> bool {
+    return raw_kinds_match<Rs...>(types);
+  }
+  static void encode(uint64_t slots[], const std::tuple<Rs...>& results) {
+    encode(slots, results, typename make_index_seq<sizeof...(Rs)>::type());
+  }
+  template<size_t... Is>
+  static void encode(
+    uint64_t slots[], const std::tuple<Rs...>& results, index_seq<Is...>
+  ) {
+    int expand[] = {0, ((slots[Is] = raw_encode(std::get<Is>(results))), 0)...};
+    (void)expand;
+  }
+  static void decode(const uint64_t slots[], std::tuple<Rs...>* results) {
+    decode(slots, results, typename make_index_seq<sizeof...(Rs)>::type());
+  }
+  template<size_t... Is>
+  static void decode(
+    const uint64_t slots[], std::tuple<Rs...>* results, index_seq<Is...>
+  ) {
+    int expand[] = {0, ((std::get<Is>(*results) = raw_decode<Rs>(slots[Is])), 0)...};
+    (void)expand;
+  }
+};
+
+template<class F> class TypedFunc;
+
+template<class R, class... Args>
+class TypedFunc<R(Args...)> {
+  using results_type = raw_results<R>;
+  static constexpr size_t param_arity = sizeof...(Args);
+  static constexpr size_t slot_count =
+    param_arity > results_type::arity ? param_arity : results_type::arity;
+
+  const Func* func_ = nullptr;
+  Func::RawTarget target_;
+
+  TypedFunc(const Func* func, const Func::RawTarget& target) :
+    func_(func), target_(target) {}
+
+public:
+  TypedFunc() = default;
+
+  // Returns an unbound handle if the signature does not match.
+  static auto bind(const Func* func) -> TypedFunc {
+    if (func == nullptr) return TypedFunc();
+    auto type = func->type();
+    if (!type || !raw_kinds_match<Args...>(type->params())) return TypedFunc();
+    if (!results_type::match(type->results())) return TypedFunc();
+    auto target = func->prepare_raw();
+    if (!target) return TypedFunc();
+    return TypedFunc(func, target);
+  }
+
+  explicit operator bool() const { return func_ != nullptr; }
+  auto func() const -> const Func* { return func_; }
+
+  // Results are stored in *results unless it is null.
+  auto call(Args... args, R* results = nullptr) const -> own<Trap> {
+    assert(func_);
+    uint64_t slots[slot_count > 0 ? slot_count : 1] = {raw_encode(args)...};
+    auto trap = func_->call_raw(target_, slots);
+    if (!trap && results) results_type::decode(slots, results);
+    return trap;
+  }
+};
+
+
+// Typed Host Functions
+
+// Host functions with a numeric signature can be created from any callable
+// taking and returning the corresponding C++ types. The function type is
+// derived from the signature, and arguments and results are marshalled
+// through raw slots by code generated for it. To trap, the callable may
+// take an additional trailing own<Trap>* parameter.
+//
+//   auto add = Func::make<int32_t(int32_t, int32_t)>(store,
+//     [](int32_t x, int32_t y) { return x + y; });
+
+template<class F> struct raw_host;
+
+// Whether a callable takes a trailing own<Trap>* after its arguments.
+template<class F, class... Args>
+struct raw_host_takes_trap {
+  template<class G>
+  static auto test(int) -> decltype(
+    std::declval<G&>()(std::declval<Args>()..., std::declval<own<Trap>*>()),
+    std::true_type());
+  template<class G>
+  static auto test(...) -> std::false_type;
+  using type = decltype(test<F>(0));
+};
+
+template<class R, class... Args>
+struct raw_host<R(Args...)> {
+  using results_type = raw_results<R>;
+
+  static auto type() -> own<FuncType> {
+    return FuncType::make(
+      ownvec<ValType>::make(ValType::make(raw_kind<Args>::kind)...),
+      results_type::types());
+  }
+
+  template<class F>
+  static auto callback(void* env, uint64_t slots[]) -> own<Trap> {
+    return invoke(*static_cast<F*>(env), slots,
+      typename make_index_seq<sizeof...(Args)>::type());
+  }
+
+  template<class F, class Seq>
+  static auto invoke(F& f, uint64_t slots[], Seq seq) -> own<Trap> {
+    own<Trap> trap;
+    invoke(f, slots, &trap, seq, std::is_void<R>());
+    return trap;
+  }
+
+  template<class F, class Seq>
+  static void invoke(
+    F& f, uint64_t slots[], own<Trap>* trap, Seq seq, std::true_type /* void */
+  ) {
+    call(f, slots, trap, seq, typename raw_host_takes_trap<F, Args...>::type());
+  }
+
+  template<class F, class Seq>
+  static void invoke(
+    F& f, uint64_t slots[], own<Trap>* trap, Seq seq, std::false_type /* void */
+  ) {
+    auto results =
+      call(f, slots, trap, seq, typename raw_host_takes_trap<F, Args...>::type());
+    if (!*trap) results_type::encode(slots, results);
+  }
+
+  template<class F, size_t... Is>
+  static auto call(
+    F& f, uint64_t slots[], own<Trap>* trap, index_seq<Is...>, std::true_type
+  ) -> R {
+    return f(raw_decode<Args>(slots[Is])..., trap);
+  }
+
+  template<class F, size_t... Is>
+  static auto call(
+    F& f, uint64_t slots[], own<Trap>*, index_seq<Is...>, std::false_type
+  ) -> R {
+    return f(raw_decode<Args>(slots[Is])...);
+  }
 };
 
+template<class Sig, class F>
+auto Func::make(Store* store, F&& callable) -> own<Func> {
+  using host = raw_host<Sig>;
+  using callable_type = typename std::decay<F>::type;
+  auto type = host::type();
+  if (!type) return own<Func>();
+  auto env = new(std::nothrow) callable_type(std::forward<F>(callable));
+  if (!env) return own<Func>();
+  auto func = make_raw(store, type.get(), &host::template callback<callable_type>,
+    env, [](void* env) { delete static_cast<callable_type*>(env); });
+  // Only a function that was created owns env, see make_raw.
+  if (!func) delete env;
+  return func;
+}
+
 
 // Global Instances
 
@@ -834,6 +1296,57 @@ public:
   auto copy() const -> own<Instance>;
 
   auto exports() const -> ownvec<Extern>;
+  // Look up a single export, or return null if there is none. Indices are
+  // those of Module::exports().
+  auto export_by_name(const char* name, size_t size) const -> own<Extern>;
+  auto export_by_name(const Name& name) const -> own<Extern> {
+    return export_by_name(name.get(), name.size());
+  }
+  auto export_by_name(const char* name) const -> own<Extern> {
+    return export_by_name(name, std::strlen(name));
+  }
+  auto export_by_index(size_t) const -> own<Extern>;
+};
+
+
+// Linking
+
+class InstancePre;
+
+class WASM_API_EXTERN Linker {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  Linker() = default;
+  ~Linker() = default;
+
+public:
+  static auto make(Store*) -> own<Linker>;
+
+  // Replaces any previous definition with the same names. Returns false,
+  // leaving the definitions unchanged, if the extern is from another store
+  // or out of memory.
+  auto define(const Name& module, const Name& name, const Extern*) -> bool;
+
+  // Resolves and type-checks a module's imports against the definitions.
+  // On failure, returns null and reports the reason as a trap.
+  auto resolve(const Module*, own<Trap>* = nullptr) const -> own<InstancePre>;
+  auto instantiate(const Module*, own<Trap>* = nullptr) const -> own<Instance>;
+};
+
+// A module with resolved imports, for repeated instantiation without
+// import lookup. Later changes to the linker do not affect it.
+class WASM_API_EXTERN InstancePre {
+  friend class destroyer;
+  void destroy();
+
+protected:
+  InstancePre() = default;
+  ~InstancePre() = default;
+
+public:
+  auto instantiate(own<Trap>* = nullptr) const -> own<Instance>;
 };
 
 
@@ -88,47 +88,6 @@ void encode_const_zero(char*& ptr, const ValType* type) {
 }
 
 
-auto wrapper(const FuncType* type) -> vec<byte_t> {
-  auto in_arity = type->params().size();
-  auto out_arity = type->results().size();
-  auto size = 39 + in_arity + out_arity;
-  auto binary = vec<byte_t>::make_uninitialized(size);
-  auto ptr = binary.get();
-
-  encode_header(ptr);
-
-  *ptr++ = 0x01;  // type section
-  encode_size32(ptr, 12 + in_arity + out_arity);  // size
-  *ptr++ = 1;  // length
-  *ptr++ = 0x60;  // function
-  encode_size32(ptr, in_arity);
-  for (size_t i = 0; i < in_arity; ++i) {
-    encode_valtype(ptr, type->params()[i].get());
-  }
-  encode_size32(ptr, out_arity);
-  for (size_t i = 0; i < out_arity; ++i) {
-    encode_valtype(ptr, type->results()[i].get());
-  }
-
-  *ptr++ = 0x02;  // import section
-  *ptr++ = 5;  // size
-  *ptr++ = 1;  // length
-  *ptr++ = 0;  // module length
-  *ptr++ = 0;  // name length
-  *ptr++ = 0x00;  // func
-  *ptr++ = 0;  // type index
-
-  *ptr++ = 0x07;  // export section
-  *ptr++ = 4;  // size
-  *ptr++ = 1;  // length
-  *ptr++ = 0;  // name length
-  *ptr++ = 0x00;  // func
-  *ptr++ = 0;  // func index
-
-  assert(ptr - binary.get() == size);
-  return binary;
-}
-
 auto wrapper(const GlobalType* type) -> vec<byte_t> {
   auto size = 25 + zero_size(type->content());
   auto binary = vec<byte_t>::make_uninitialized(size);
@@ -566,5 +525,44 @@ auto exports(const vec<byte_t>& binary) -> ownvec<ExportType> {
   return bin::exports(binary, funcs, globals, tables, memories);
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+// Hashing
+
+// 64-bit hash of the raw bytes, consuming a word at a time (MurmurHash3
+// mixing), for keying caches of compiled modules.
+
+inline auto rotl(uint64_t x, int n) -> uint64_t {
+  return (x << n) | (x >> (64 - n));
+}
+
+inline auto fmix(uint64_t h) -> uint64_t {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+auto hash(const byte_t* data, size_t size) -> uint64_t {
+  const uint64_t c1 = 0x87c37b91114253d5ull;
+  const uint64_t c2 = 0x4cf5ad432745937full;
+  uint64_t h = size;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t k;
+    std::memcpy(&k, data + i, 8);
+    h ^= rotl(k * c1, 31) * c2;
+    h = rotl(h, 27) * 5 + 0x52dce729;
+  }
+  uint64_t k = 0;
+  for (size_t j = 0; i + j < size; ++j) {
+    k |= uint64_t(static_cast<uint8_t>(data[i + j])) << (8 * j);
+  }
+  h ^= rotl(k * c1, 31) * c2;
+  return fmix(h);
+}
+
 }  // namespace bin
 }  // namespace wasm
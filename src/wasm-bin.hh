@@ -13,12 +13,13 @@ void encode_u64(char*& ptr, uint64_t n);
 auto u32(const byte_t*& pos) -> uint32_t;
 auto u64(const byte_t*& pos) -> uint64_t;
 
-auto wrapper(const FuncType*) -> vec<byte_t>;
 auto wrapper(const GlobalType*) -> vec<byte_t>;
 
 auto imports(const vec<byte_t>& binary) -> ownvec<ImportType>;
 auto exports(const vec<byte_t>& binary) -> ownvec<ExportType>;
 
+auto hash(const byte_t* data, size_t size) -> uint64_t;
+
 }  // namespace bin
 }  // namespace wasm
 
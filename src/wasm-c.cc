@@ -211,6 +211,14 @@ wasm_config_t* wasm_config_new() {
   return release_config(Config::make());
 }
 
+void wasm_config_set_code_cache_dir(wasm_config_t* config, const char* dir) {
+  config->set_code_cache_dir(dir);
+}
+
+void wasm_config_set_snapshot(wasm_config_t* config, wasm_byte_vec_t* snapshot) {
+  config->set_snapshot(adopt_byte_vec(snapshot));
+}
+
 
 // Engine
 
@@ -224,6 +232,10 @@ wasm_engine_t* wasm_engine_new_with_config(wasm_config_t* config) {
   return release_engine(Engine::make(adopt_config(config)));
 }
 
+void wasm_engine_make_snapshot(const wasm_engine_t* engine, wasm_byte_vec_t* out) {
+  *out = release_byte_vec(engine->make_snapshot());
+}
+
 
 // Stores
 
@@ -233,6 +245,45 @@ wasm_store_t* wasm_store_new(wasm_engine_t* engine) {
   return release_store(Store::make(engine));
 };
 
+size_t wasm_store_wrapper_cache_hits(const wasm_store_t* store) {
+  return store->wrapper_cache_hits();
+}
+
+size_t wasm_store_wrapper_cache_misses(const wasm_store_t* store) {
+  return store->wrapper_cache_misses();
+}
+
+size_t wasm_store_run_pending(wasm_store_t* store, bool wait) {
+  return store->run_pending(wait);
+}
+
+bool wasm_store_reset(wasm_store_t* store) {
+  return store->reset();
+}
+
+
+// Store pools
+
+WASM_DEFINE_OWN(store_pool, StorePool)
+
+wasm_store_pool_t* wasm_store_pool_new(
+  wasm_engine_t* engine, size_t capacity, size_t warm
+) {
+  return release_store_pool(StorePool::make(engine, capacity, warm));
+}
+
+wasm_store_t* wasm_store_pool_acquire(wasm_store_pool_t* pool) {
+  return release_store(pool->acquire());
+}
+
+void wasm_store_pool_release(wasm_store_pool_t* pool, wasm_store_t* store) {
+  pool->release(adopt_store(store));
+}
+
+size_t wasm_store_pool_idle_count(const wasm_store_pool_t* pool) {
+  return pool->idle_count();
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
@@ -753,10 +804,59 @@ void wasm_module_exports(
   *out = release_exporttype_vec(reveal_module(module)->exports());
 }
 
+uint64_t wasm_module_hash(const wasm_module_t* module) {
+  return reveal_module(module)->hash();
+}
+
 void wasm_module_serialize(const wasm_module_t* module, wasm_byte_vec_t* out) {
   *out = release_byte_vec(reveal_module(module)->serialize());
 }
 
+extern "C++" {
+
+struct wasm_module_async_env_t {
+  wasm_module_callback_t callback;
+  void* env;
+};
+
+void wasm_module_async_callback(void* env, own<Module>&& module) {
+  auto t = static_cast<wasm_module_async_env_t*>(env);
+  t->callback(t->env, release_module(std::move(module)));
+  delete t;
+}
+
+}  // extern "C++"
+
+void wasm_module_new_async(
+  wasm_store_t* store, wasm_byte_vec_t* binary,
+  wasm_module_callback_t callback, void* env
+) {
+  Module::make_async(store, adopt_byte_vec(binary), wasm_module_async_callback,
+    new wasm_module_async_env_t{callback, env});
+}
+
+uint64_t wasm_module_new_many(
+  wasm_store_t* store, size_t n, wasm_module_bulk_item_t items[],
+  size_t max_parallel
+) {
+  std::vector<vec<byte_t>> bytes;
+  bytes.reserve(n);
+  auto items2 = std::unique_ptr<Module::BulkItem[]>(new Module::BulkItem[n]);
+  for (size_t i = 0; i < n; ++i) {
+    bytes.push_back(
+      vec<byte_t>::adopt(items[i].bytes->size, items[i].bytes->data));
+    items2[i].bytes = &bytes[i];
+    items2[i].serialized = items[i].serialized;
+  }
+  auto time_ns = Module::make_many(store, n, items2.get(), max_parallel);
+  for (size_t i = 0; i < n; ++i) {
+    bytes[i].release();
+    items[i].module = release_module(std::move(items2[i].module));
+    items[i].time_ns = items2[i].time_ns;
+  }
+  return time_ns;
+}
+
 wasm_module_t* wasm_module_deserialize(
   wasm_store_t* store, const wasm_byte_vec_t* binary
 ) {
@@ -764,6 +864,38 @@ wasm_module_t* wasm_module_deserialize(
   return release_module(Module::deserialize(store, binary_.it));
 }
 
+bool wasm_module_serialize_to(
+  const wasm_module_t* module, wasm_module_writer_t writer, void* env
+) {
+  return reveal_module(module)->serialize_to(writer, env);
+}
+
+bool wasm_module_serialize_to_fd(const wasm_module_t* module, int fd) {
+  return reveal_module(module)->serialize_to_fd(fd);
+}
+
+wasm_module_t* wasm_module_deserialize_from(
+  wasm_store_t* store, wasm_module_reader_t reader, void* env
+) {
+  return release_module(Module::deserialize_from(store, reader, env));
+}
+
+WASM_DEFINE_OWN(module_streamer, ModuleStreamer)
+
+wasm_module_streamer_t* wasm_module_streamer_new(wasm_store_t* store) {
+  return release_module_streamer(ModuleStreamer::make(store));
+}
+
+void wasm_module_streamer_feed(
+  wasm_module_streamer_t* streamer, const wasm_byte_vec_t* chunk
+) {
+  streamer->feed(chunk->data, chunk->size);
+}
+
+wasm_module_t* wasm_module_streamer_finish(wasm_module_streamer_t* streamer) {
+  return release_module(streamer->finish());
+}
+
 wasm_shared_module_t* wasm_module_share(const wasm_module_t* module) {
   return release_shared_module(reveal_module(module)->share());
 }
@@ -805,6 +937,36 @@ void wasm_callback_env_finalizer(void* env) {
   delete t;
 }
 
+struct wasm_callback_raw_env_t {
+  wasm_func_callback_raw_t callback;
+  void* env;
+  void (*finalizer)(void*);
+};
+
+auto wasm_callback_raw(void* env, uint64_t slots[]) -> own<Trap> {
+  auto t = static_cast<wasm_callback_raw_env_t*>(env);
+  return adopt_trap(t->callback(t->env, slots));
+}
+
+void wasm_callback_raw_env_finalizer(void* env) {
+  auto t = static_cast<wasm_callback_raw_env_t*>(env);
+  if (t->finalizer) t->finalizer(t->env);
+  delete t;
+}
+
+struct wasm_async_env_t {
+  wasm_func_async_callback_t callback;
+  void* env;
+};
+
+void wasm_async_callback(void* env, Func::CallResult& result) {
+  auto t = static_cast<wasm_async_env_t*>(env);
+  t->callback(t->env,
+    result.results ? hide_val_vec(result.results) : nullptr,
+    result.trap ? hide_byte_vec(result.trap) : nullptr);
+  delete t;
+}
+
 }  // extern "C++"
 
 wasm_func_t* wasm_func_new(
@@ -823,6 +985,40 @@ wasm_func_t *wasm_func_new_with_env(
   return release_func(Func::make(store, type, wasm_callback_with_env, env2, wasm_callback_env_finalizer));
 }
 
+wasm_func_t *wasm_func_new_raw(
+  wasm_store_t* store, const wasm_functype_t* type,
+  wasm_func_callback_raw_t callback, void *env, void (*finalizer)(void*)
+) {
+  auto env2 = new wasm_callback_raw_env_t{callback, env, finalizer};
+  auto func = Func::make_raw(store, type, wasm_callback_raw, env2, wasm_callback_raw_env_finalizer);
+  if (!func) delete env2;
+  return release_func(std::move(func));
+}
+
+void wasm_func_new_many(
+  wasm_store_t* store, size_t n, const wasm_func_def_t defs[], wasm_func_t* out[]
+) {
+  auto defs2 = std::unique_ptr<Func::Def[]>(new Func::Def[n]);
+  auto envs = std::unique_ptr<std::unique_ptr<wasm_callback_env_t>[]>(
+    new std::unique_ptr<wasm_callback_env_t>[n]);
+  for (size_t i = 0; i < n; ++i) {
+    envs[i].reset(new wasm_callback_env_t{
+      defs[i].callback, defs[i].env, defs[i].finalizer});
+    defs2[i] = {defs[i].type, wasm_callback_with_env, envs[i].get(),
+      wasm_callback_env_finalizer};
+  }
+  auto funcs = Func::make_many(store, n, defs2.get());
+  if (!funcs) {
+    // The environments are still ours and are freed with envs.
+    for (size_t i = 0; i < n; ++i) out[i] = nullptr;
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    envs[i].release();
+    out[i] = release_func(std::move(funcs[i]));
+  }
+}
+
 wasm_functype_t* wasm_func_type(const wasm_func_t* func) {
   return release_functype(func->type());
 }
@@ -843,6 +1039,64 @@ wasm_trap_t* wasm_func_call(
   return release_trap(func->call(args_.it, results_.it));
 }
 
+wasm_trap_t* wasm_func_call_unchecked(
+  const wasm_func_t* func, const wasm_val_t args[], wasm_val_t results[]
+) {
+  return release_trap(func->call_unchecked(
+    reveal_val_vec(args), reveal_val_vec(results)));
+}
+
+wasm_trap_t* wasm_func_call_raw(const wasm_func_t* func, uint64_t slots[]) {
+  return release_trap(func->call_raw(slots));
+}
+
+void wasm_func_call_async(
+  wasm_store_t* store, const wasm_func_t* func, wasm_val_vec_t* args,
+  wasm_func_async_callback_t callback, void* env
+) {
+  auto env2 = new(std::nothrow) wasm_async_env_t{callback, env};
+  if (!env2) {
+    adopt_val_vec(args);
+    auto trap = Message::make_nt(std::string("out of memory"));
+    callback(env, nullptr, hide_byte_vec(trap));
+    return;
+  }
+  func->call_async(store, adopt_val_vec(args), wasm_async_callback, env2);
+}
+
+size_t wasm_func_call_columns(
+  const wasm_func_t* func, size_t n,
+  const wasm_column_t params[], const wasm_column_t results[],
+  wasm_trap_t** first_trap
+) {
+  auto param_arity = func->param_arity();
+  auto result_arity = func->result_arity();
+  auto columns = std::unique_ptr<Column[]>(new Column[param_arity + result_arity]);
+  for (size_t i = 0; i < param_arity; ++i) {
+    columns[i] = {static_cast<ValKind>(params[i].kind), params[i].data};
+  }
+  for (size_t i = 0; i < result_arity; ++i) {
+    columns[param_arity + i] =
+      {static_cast<ValKind>(results[i].kind), results[i].data};
+  }
+  own<Trap> trap;
+  auto count = func->call_columns(
+    n, columns.get(), columns.get() + param_arity, &trap);
+  if (first_trap) *first_trap = release_trap(std::move(trap));
+  return count;
+}
+
+size_t wasm_func_call_batch(
+  const wasm_func_t* func, size_t n,
+  const wasm_val_t args[], wasm_val_t results[], wasm_trap_t** first_trap
+) {
+  own<Trap> trap;
+  auto count = func->call_batch(
+    n, reveal_val_vec(args), reveal_val_vec(results), &trap);
+  if (first_trap) *first_trap = release_trap(std::move(trap));
+  return count;
+}
+
 
 // Global Instances
 
@@ -1024,9 +1278,67 @@ void wasm_instance_exports(
   *out = release_extern_vec(instance->exports());
 }
 
+wasm_extern_t* wasm_instance_export_by_name(
+  const wasm_instance_t* instance, const wasm_name_t* name
+) {
+  return release_extern(instance->export_by_name(name->data, name->size));
+}
+
+wasm_extern_t* wasm_instance_export_by_index(
+  const wasm_instance_t* instance, size_t index
+) {
+  return release_extern(instance->export_by_index(index));
+}
+
 
 wasm_instance_t* wasm_frame_instance(const wasm_frame_t* frame) {
   return hide_instance(reveal_frame(frame)->instance());
 }
 
+
+// Linking
+
+WASM_DEFINE_OWN(linker, Linker)
+WASM_DEFINE_OWN(instance_pre, InstancePre)
+
+wasm_linker_t* wasm_linker_new(wasm_store_t* store) {
+  return release_linker(Linker::make(store));
+}
+
+bool wasm_linker_define(
+  wasm_linker_t* linker, const wasm_name_t* module, const wasm_name_t* name,
+  const wasm_extern_t* external
+) {
+  auto module_ = borrow_byte_vec(module);
+  auto name_ = borrow_byte_vec(name);
+  return linker->define(module_.it, name_.it, external);
+}
+
+wasm_instance_pre_t* wasm_linker_resolve(
+  const wasm_linker_t* linker, const wasm_module_t* module, wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto pre = release_instance_pre(linker->resolve(module, &error));
+  if (trap) *trap = hide_trap(error.release());
+  return pre;
+}
+
+wasm_instance_t* wasm_linker_instantiate(
+  const wasm_linker_t* linker, const wasm_module_t* module, wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto instance = release_instance(linker->instantiate(module, &error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
+wasm_instance_t* wasm_instance_pre_instantiate(
+  const wasm_instance_pre_t* pre, wasm_trap_t** trap
+) {
+  own<Trap> error;
+  auto instance = release_instance(pre->instantiate(&error));
+  if (trap) *trap = hide_trap(error.release());
+  return instance;
+}
+
 }  // extern "C"
@@ -15,12 +15,25 @@
 
 #include "api/api.h"
 #include "api/api-inl.h"
+#include "builtins/builtins.h"
+#include "compiler/wasm-compiler.h"
+#include "execution/execution.h"
+#include "wasm/compilation-environment.h"
+#include "wasm/wasm-arguments.h"
+#include "wasm/wasm-engine.h"
+#include "wasm/wasm-features.h"
 #include "wasm/wasm-objects.h"
 #include "wasm/wasm-objects-inl.h"
 #include "wasm/wasm-serialization.h"
+#include "wasm/streaming-decoder.h"
 
+#include "base/memory.h"
 #include "flags/flags.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 
 namespace v8 {
 namespace wasm {
@@ -32,6 +45,10 @@ void flags_init() {
   v8::internal::v8_flags.expose_gc = true;
 }
 
+auto flags_hash() -> uint32_t {
+  return v8::internal::FlagList::Hash();
+}
+
 
 // Objects
 
@@ -64,7 +81,8 @@ auto object_is_instance(v8::Local<v8::Object> obj) -> bool {
 
 auto object_is_func(v8::Local<v8::Object> obj) -> bool {
   auto v8_obj = v8::Utils::OpenHandle(*obj);
-  return v8::internal::WasmExportedFunction::IsWasmExportedFunction(*v8_obj);
+  return v8::internal::WasmExportedFunction::IsWasmExportedFunction(*v8_obj) ||
+    v8::internal::WasmCapiFunction::IsWasmCapiFunction(*v8_obj);
 }
 
 auto object_is_global(v8::Local<v8::Object> obj) -> bool {
@@ -160,6 +178,18 @@ auto v8_valtype_to_wasm(v8::internal::wasm::ValueType v8_valtype) -> val_kind_t
   UNREACHABLE();
 }
 
+auto wasm_valtype_to_v8(val_kind_t kind) -> v8::internal::wasm::ValueType {
+  switch (kind) {
+    case I32: return v8::internal::wasm::kWasmI32;
+    case I64: return v8::internal::wasm::kWasmI64;
+    case F32: return v8::internal::wasm::kWasmF32;
+    case F64: return v8::internal::wasm::kWasmF64;
+    case EXTERNREF: return v8::internal::wasm::kWasmExternRef;
+    case FUNCREF: return v8::internal::wasm::kWasmFuncRef;
+  }
+  UNREACHABLE();
+}
+
 auto func_type_param_arity(v8::Local<v8::Object> function) -> uint32_t {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(function);
   auto v8_function = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_object);
@@ -192,6 +222,15 @@ auto func_type_result(v8::Local<v8::Object> function, size_t i) -> val_kind_t {
   return v8_valtype_to_wasm(sig->GetReturn(i));
 }
 
+auto func_type_index(v8::Local<v8::Object> function) -> uint32_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(function);
+  auto v8_function = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_object);
+  auto module = v8_function->instance().module();
+  auto sig_index = module->functions[v8_function->function_index()].sig_index;
+  // Canonical indices are engine-wide, so equal signatures share an index.
+  return module->isorecursive_canonical_type_ids[sig_index];
+}
+
 auto global_type_content(v8::Local<v8::Object> global) -> val_kind_t {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(global);
   auto v8_global = v8::internal::Handle<v8::internal::WasmGlobalObject>::cast(v8_object);
@@ -231,6 +270,78 @@ auto memory_type_max(v8::Local<v8::Object> memory) -> uint32_t {
 
 // Modules
 
+auto module_compile(
+  v8::Isolate* isolate, const uint8_t* binary, size_t size
+) -> v8::MaybeLocal<v8::Object> {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  v8::EscapableHandleScope handle_scope(isolate);
+  auto features = v8::internal::wasm::WasmFeatures::FromIsolate(v8_isolate);
+  v8::internal::wasm::ErrorThrower thrower(v8_isolate, "WebAssembly.Module()");
+  auto maybe_v8_module = v8::internal::wasm::GetWasmEngine()->SyncCompile(
+    v8_isolate, features, &thrower,
+    v8::internal::wasm::ModuleWireBytes(binary, binary + size));
+  if (maybe_v8_module.is_null()) {
+    thrower.Reset();
+    return v8::MaybeLocal<v8::Object>();
+  }
+  auto v8_module = v8::internal::Handle<v8::internal::JSObject>::cast(maybe_v8_module.ToHandleChecked());
+  return handle_scope.Escape(v8::Utils::ToLocal(v8_module));
+}
+
+class AsyncCompileResolver : public v8::internal::wasm::CompilationResultResolver {
+ public:
+  AsyncCompileResolver(module_callback_t callback, void* env)
+    : callback_(callback), env_(env) {}
+
+  // Compile jobs are dropped without a result when the isolate shuts down.
+  ~AsyncCompileResolver() override {
+    if (!done_) callback_(env_, v8::Local<v8::Object>());
+  }
+
+  void OnCompilationSucceeded(
+    v8::internal::Handle<v8::internal::WasmModuleObject> result
+  ) override {
+    done_ = true;
+    auto v8_module = v8::internal::Handle<v8::internal::JSObject>::cast(result);
+    callback_(env_, v8::Utils::ToLocal(v8_module));
+  }
+
+  void OnCompilationFailed(
+    v8::internal::Handle<v8::internal::Object> error_reason
+  ) override {
+    done_ = true;
+    callback_(env_, v8::Local<v8::Object>());
+  }
+
+ private:
+  module_callback_t callback_;
+  void* env_;
+  bool done_ = false;
+};
+
+void module_compile_async(
+  v8::Isolate* isolate, const uint8_t* binary, size_t size,
+  module_callback_t callback, void* env
+) {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto features = v8::internal::wasm::WasmFeatures::FromIsolate(v8_isolate);
+  v8::internal::wasm::GetWasmEngine()->AsyncCompile(
+    v8_isolate, features,
+    std::make_shared<AsyncCompileResolver>(callback, env),
+    v8::internal::wasm::ModuleWireBytes(binary, binary + size),
+    false, "WebAssembly.compile()");
+}
+
+auto module_validate(
+  v8::Isolate* isolate, const uint8_t* binary, size_t size
+) -> bool {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto features = v8::internal::wasm::WasmFeatures::FromIsolate(v8_isolate);
+  return v8::internal::wasm::GetWasmEngine()->SyncValidate(
+    v8_isolate, features,
+    v8::internal::wasm::ModuleWireBytes(binary, binary + size));
+}
+
 auto module_binary_size(v8::Local<v8::Object> module) -> size_t {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
   auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
@@ -257,6 +368,43 @@ auto module_serialize(v8::Local<v8::Object> module, char* buffer, size_t size) -
   return serializer.SerializeNativeModule({reinterpret_cast<uint8_t*>(buffer), size});
 }
 
+class ModuleSerializeTask : public v8::Task {
+ public:
+  ModuleSerializeTask(
+    std::shared_ptr<v8::internal::wasm::NativeModule> native_module,
+    module_serialized_callback_t callback, void* env
+  ) : native_module_(std::move(native_module)), callback_(callback), env_(env) {}
+
+  void Run() override {
+    // Blocks until every function has top-tier code, so that the serialized
+    // module does not consist of Liftoff code or uncompiled lazy functions.
+    native_module_->compilation_state()->TierUpAllFunctions();
+    v8::internal::wasm::WasmSerializer serializer(native_module_.get());
+    auto size = serializer.GetSerializedNativeModuleSize();
+    std::unique_ptr<uint8_t[]> buffer(new(std::nothrow) uint8_t[size]);
+    if (buffer && !serializer.SerializeNativeModule({buffer.get(), size})) {
+      buffer.reset();
+    }
+    auto bytes = native_module_->wire_bytes();
+    callback_(env_, bytes.begin(), bytes.size(), buffer.get(), buffer ? size : 0);
+  }
+
+ private:
+  std::shared_ptr<v8::internal::wasm::NativeModule> native_module_;
+  module_serialized_callback_t callback_;
+  void* env_;
+};
+
+void module_serialize_async(
+  v8::Platform* platform, v8::Local<v8::Object> module,
+  module_serialized_callback_t callback, void* env
+) {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
+  auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
+  platform->CallOnWorkerThread(std::make_unique<ModuleSerializeTask>(
+    v8_module->shared_native_module(), callback, env));
+}
+
 auto module_deserialize(
   v8::Isolate* isolate,
   const uint8_t* binary, size_t binary_size,
@@ -274,8 +422,208 @@ auto module_deserialize(
 }
 
 
+class StreamingResolver : public v8::internal::wasm::CompilationResultResolver {
+ public:
+  explicit StreamingResolver(v8::Isolate* isolate) : isolate_(isolate) {}
+
+  void OnCompilationSucceeded(
+    v8::internal::Handle<v8::internal::WasmModuleObject> result
+  ) override {
+    auto v8_module = v8::internal::Handle<v8::internal::JSObject>::cast(result);
+    module_.Reset(isolate_, v8::Utils::ToLocal(v8_module));
+    done_ = true;
+  }
+
+  void OnCompilationFailed(
+    v8::internal::Handle<v8::internal::Object> error_reason
+  ) override {
+    done_ = true;
+  }
+
+  auto done() const -> bool { return done_; }
+  auto module() const -> v8::Local<v8::Object> { return module_.Get(isolate_); }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Global<v8::Object> module_;
+  bool done_ = false;
+};
+
+struct module_streamer_t {
+  std::shared_ptr<StreamingResolver> resolver;
+  std::shared_ptr<v8::internal::wasm::StreamingDecoder> decoder;
+  bool finished;
+};
+
+auto module_streamer_new(v8::Isolate* isolate) -> module_streamer_t* {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto features = v8::internal::wasm::WasmFeatures::FromIsolate(v8_isolate);
+  auto resolver = std::make_shared<StreamingResolver>(isolate);
+  auto decoder = v8::internal::wasm::GetWasmEngine()->StartStreamingCompilation(
+    v8_isolate, features, v8_isolate->native_context(),
+    "WebAssembly.compileStreaming()", resolver);
+  if (!decoder) return nullptr;
+  auto streamer = new(std::nothrow) module_streamer_t{resolver, decoder, false};
+  if (!streamer) decoder->Abort();
+  return streamer;
+}
+
+void module_streamer_feed(
+  module_streamer_t* streamer, const uint8_t* data, size_t size
+) {
+  assert(!streamer->finished);
+  streamer->decoder->OnBytesReceived({data, size});
+}
+
+void module_streamer_finish(module_streamer_t* streamer) {
+  assert(!streamer->finished);
+  streamer->finished = true;
+  streamer->decoder->Finish();
+}
+
+auto module_streamer_done(module_streamer_t* streamer) -> bool {
+  return streamer->resolver->done();
+}
+
+auto module_streamer_result(module_streamer_t* streamer) -> v8::MaybeLocal<v8::Object> {
+  auto module = streamer->resolver->module();
+  if (module.IsEmpty()) return v8::MaybeLocal<v8::Object>();
+  return module;
+}
+
+void module_streamer_delete(module_streamer_t* streamer) {
+  if (!streamer->finished) streamer->decoder->Abort();
+  delete streamer;
+}
+
+
 // Instances
 
+auto instance_imports_layout(v8::Local<v8::Object> module) -> v8::Local<v8::Array> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
+  auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
+  auto isolate = v8_module->GetIsolate();
+  v8::EscapableHandleScope handle_scope(reinterpret_cast<v8::Isolate*>(isolate));
+
+  // V8 resolves imports by name, so build the imports object directly,
+  // using the internalized names from the module's wire bytes. Imports
+  // from the same module are usually adjacent, and are grouped by identity
+  // of their internalized module name. The layout lists the imports object,
+  // then the module object and field name of each import.
+  auto factory = isolate->factory();
+  auto imports_obj = factory->NewJSObject(isolate->object_function());
+  auto& import_table = v8_module->module()->import_table;
+  auto layout = factory->NewFixedArray(
+    static_cast<int>(1 + 2 * import_table.size()));
+  layout->set(0, *imports_obj);
+  std::vector<std::pair<
+    v8::internal::Handle<v8::internal::String>,
+    v8::internal::Handle<v8::internal::JSObject>>> module_objs;
+  for (size_t i = 0; i < import_table.size(); ++i) {
+    auto& import = import_table[i];
+    auto module_name = v8::internal::WasmModuleObject::ExtractUtf8StringFromModuleBytes(
+      isolate, v8_module, import.module_name, v8::internal::kInternalize);
+    auto field_name = v8::internal::WasmModuleObject::ExtractUtf8StringFromModuleBytes(
+      isolate, v8_module, import.field_name, v8::internal::kInternalize);
+    v8::internal::Handle<v8::internal::JSObject> module_obj;
+    for (auto it = module_objs.rbegin(); it != module_objs.rend(); ++it) {
+      if (it->first.is_identical_to(module_name)) {
+        module_obj = it->second;
+        break;
+      }
+    }
+    if (module_obj.is_null()) {
+      module_obj = factory->NewJSObject(isolate->object_function());
+      v8::internal::JSObject::SetOwnPropertyIgnoreAttributes(
+        imports_obj, module_name, module_obj, v8::internal::NONE).Check();
+      module_objs.emplace_back(module_name, module_obj);
+    }
+    v8::internal::JSObject::SetOwnPropertyIgnoreAttributes(
+      module_obj, field_name, factory->undefined_value(),
+      v8::internal::NONE).Check();
+    layout->set(static_cast<int>(1 + 2 * i), *module_obj);
+    layout->set(static_cast<int>(2 + 2 * i), *field_name);
+  }
+  auto v8_layout = factory->NewJSArrayWithElements(
+    layout, v8::internal::PACKED_ELEMENTS);
+  return handle_scope.Escape(v8::Utils::ToLocal(v8_layout));
+}
+
+// Sets the imports, or clears them if there are none.
+void instance_imports_set(
+  v8::Local<v8::Array> layout, const v8::Local<v8::Object> imports[]
+) {
+  auto v8_layout = v8::Utils::OpenHandle(*layout);
+  auto isolate = v8_layout->GetIsolate();
+  v8::internal::HandleScope handle_scope(isolate);
+  auto elements = handle(
+    v8::internal::FixedArray::cast(v8_layout->elements()), isolate);
+  auto n = (elements->length() - 1) / 2;
+  for (int i = 0; i < n; ++i) {
+    auto module_obj = handle(
+      v8::internal::JSObject::cast(elements->get(1 + 2 * i)), isolate);
+    auto field_name = handle(
+      v8::internal::String::cast(elements->get(2 + 2 * i)), isolate);
+    auto value = imports
+      ? v8::internal::Handle<v8::internal::Object>::cast(
+          v8::Utils::OpenHandle(*imports[i]))
+      : v8::internal::Handle<v8::internal::Object>::cast(
+          isolate->factory()->undefined_value());
+    v8::internal::JSObject::SetOwnPropertyIgnoreAttributes(
+      module_obj, field_name, value, v8::internal::NONE).Check();
+  }
+}
+
+auto instance_imports_fill(
+  v8::Local<v8::Array> layout, const v8::Local<v8::Object> imports[]
+) -> v8::Local<v8::Object> {
+  instance_imports_set(layout, imports);
+  auto v8_layout = v8::Utils::OpenHandle(*layout);
+  auto isolate = v8_layout->GetIsolate();
+  auto elements = v8::internal::FixedArray::cast(v8_layout->elements());
+  return v8::Utils::ToLocal(handle(
+    v8::internal::JSObject::cast(elements.get(0)), isolate));
+}
+
+void instance_imports_clear(v8::Local<v8::Array> layout) {
+  instance_imports_set(layout, nullptr);
+}
+
+auto instance_imports(
+  v8::Local<v8::Object> module, const v8::Local<v8::Object> imports[]
+) -> v8::Local<v8::Object> {
+  return instance_imports_fill(instance_imports_layout(module), imports);
+}
+
+auto instance_new(
+  v8::Local<v8::Object> module, v8::Local<v8::Object> imports,
+  v8::Local<v8::Value>* exception
+) -> v8::MaybeLocal<v8::Object> {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(module);
+  auto v8_module = v8::internal::Handle<v8::internal::WasmModuleObject>::cast(v8_object);
+  auto isolate = v8_module->GetIsolate();
+  v8::EscapableHandleScope handle_scope(reinterpret_cast<v8::Isolate*>(isolate));
+  auto imports_obj = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(imports);
+
+  v8::internal::wasm::ErrorThrower thrower(isolate, "WebAssembly.Instance()");
+  auto maybe_instance = v8::internal::wasm::GetWasmEngine()->SyncInstantiate(
+    isolate, &thrower, v8_module, imports_obj, {});
+  if (thrower.error()) {
+    auto v8_exception = thrower.Reify();
+    *exception = handle_scope.Escape(v8::Utils::ToLocal(v8_exception));
+    return v8::MaybeLocal<v8::Object>();
+  }
+  if (isolate->has_pending_exception()) {
+    auto v8_exception = handle(isolate->pending_exception(), isolate);
+    isolate->clear_pending_exception();
+    *exception = handle_scope.Escape(v8::Utils::ToLocal(v8_exception));
+    return v8::MaybeLocal<v8::Object>();
+  }
+  auto v8_instance = v8::internal::Handle<v8::internal::JSObject>::cast(
+    maybe_instance.ToHandleChecked());
+  return handle_scope.Escape(v8::Utils::ToLocal(v8_instance));
+}
+
 auto instance_module(v8::Local<v8::Object> instance) -> v8::Local<v8::Object> {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(instance);
   auto v8_instance = v8::internal::Handle<v8::internal::WasmInstanceObject>::cast(v8_object);
@@ -297,6 +645,7 @@ auto extern_kind(v8::Local<v8::Object> external) -> extern_kind_t {
   auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(external);
 
   if (v8::internal::WasmExportedFunction::IsWasmExportedFunction(*v8_object)) return EXTERN_FUNC;
+  if (v8::internal::WasmCapiFunction::IsWasmCapiFunction(*v8_object)) return EXTERN_FUNC;
   if (v8_object->IsWasmGlobalObject()) return EXTERN_GLOBAL;
   if (v8_object->IsWasmTableObject()) return EXTERN_TABLE;
   if (v8_object->IsWasmMemoryObject()) return EXTERN_MEMORY;
@@ -314,6 +663,231 @@ auto func_instance(v8::Local<v8::Function> function) -> v8::Local<v8::Object> {
 }
 
 
+struct HostData {
+  HostData(
+    v8::internal::Isolate* isolate,
+    func_callback_t callback, void* env, void (*finalizer)(void*)
+  ) : isolate(isolate), callback(callback), env(env), finalizer(finalizer) {}
+
+  ~HostData() {
+    if (finalizer) (*finalizer)(env);
+  }
+
+  v8::internal::Isolate* isolate;
+  func_callback_t callback;
+  void* env;
+  void (*finalizer)(void*);
+};
+
+// Entered directly from Wasm code through V8's C API call wrapper.
+auto host_func_callback(
+  v8::internal::Address data, v8::internal::Address argv
+) -> v8::internal::Address {
+  auto host = v8::internal::Managed<HostData>::cast(
+    v8::internal::Object(data)).raw();
+  auto isolate = host->isolate;
+  v8::internal::HandleScope handle_scope(isolate);
+  host->callback(host->env, reinterpret_cast<char*>(argv));
+  if (isolate->has_scheduled_exception()) isolate->PromoteScheduledException();
+  if (!isolate->has_pending_exception()) return v8::internal::kNullAddress;
+  auto exception = isolate->pending_exception();
+  isolate->clear_pending_exception();
+  return exception.ptr();
+}
+
+auto func_sig_new(
+  v8::internal::Isolate* isolate, const val_kind_t kinds[],
+  size_t param_arity, size_t result_arity
+) -> v8::internal::Handle<v8::internal::PodArray<v8::internal::wasm::ValueType>> {
+  // Serialized signatures list results, a void marker, then params.
+  auto size = static_cast<int>(result_arity + 1 + param_arity);
+  auto sig = v8::internal::PodArray<v8::internal::wasm::ValueType>::New(
+    isolate, size, v8::internal::AllocationType::kOld);
+  int index = 0;
+  for (size_t i = 0; i < result_arity; ++i) {
+    sig->set(index++, wasm_valtype_to_v8(kinds[param_arity + i]));
+  }
+  sig->set(index++, v8::internal::wasm::kWasmVoid);
+  for (size_t i = 0; i < param_arity; ++i) {
+    sig->set(index++, wasm_valtype_to_v8(kinds[i]));
+  }
+  return sig;
+}
+
+auto func_sig_equal(const func_def_t& def1, const func_def_t& def2) -> bool {
+  return def1.param_arity == def2.param_arity &&
+    def1.result_arity == def2.result_arity &&
+    std::equal(def1.kinds, def1.kinds + def1.param_arity + def1.result_arity,
+      def2.kinds);
+}
+
+auto func_new_many(
+  v8::Isolate* isolate, size_t n, const func_def_t defs[],
+  v8::Local<v8::Function> functions[]
+) -> bool {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+
+  // Allocate all host data upfront, so that nothing is owned on failure.
+  auto hosts = std::unique_ptr<std::unique_ptr<HostData>[]>(
+    new(std::nothrow) std::unique_ptr<HostData>[n]);
+  if (!hosts) return false;
+  for (size_t i = 0; i < n; ++i) {
+    auto& def = defs[i];
+    hosts[i].reset(new(std::nothrow)
+      HostData(v8_isolate, def.callback, def.env, def.finalizer));
+    if (!hosts[i]) {
+      for (size_t j = 0; j < i; ++j) hosts[j]->finalizer = nullptr;
+      return false;
+    }
+  }
+
+  // Functions of equal type share their serialized signature.
+  std::vector<std::pair<size_t,
+    v8::internal::Handle<v8::internal::PodArray<v8::internal::wasm::ValueType>>>>
+    sigs;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto& def = defs[i];
+    auto data = v8::internal::Managed<HostData>::FromUniquePtr(
+      v8_isolate, sizeof(HostData), std::move(hosts[i]));
+
+    auto it = std::find_if(sigs.begin(), sigs.end(),
+      [&](const auto& sig) { return func_sig_equal(defs[sig.first], def); });
+    if (it == sigs.end()) {
+      sigs.emplace_back(i, func_sig_new(
+        v8_isolate, def.kinds, def.param_arity, def.result_arity));
+      it = sigs.end() - 1;
+    }
+
+    auto v8_function = v8::internal::WasmCapiFunction::New(v8_isolate,
+      reinterpret_cast<v8::internal::Address>(&host_func_callback),
+      data, it->second);
+    v8::internal::WasmApiFunctionRef::cast(
+      v8_function->shared().wasm_capi_function_data().internal().ref()
+    ).set_callable(*v8_function);
+    functions[i] = v8::Utils::ToLocal(
+      v8::internal::Handle<v8::internal::JSFunction>::cast(v8_function));
+  }
+  return true;
+}
+
+auto func_is_host(v8::Local<v8::Object> function) -> bool {
+  auto v8_function = v8::Utils::OpenHandle(*function);
+  return v8::internal::WasmCapiFunction::IsWasmCapiFunction(*v8_function);
+}
+
+auto func_host_env(v8::Local<v8::Object> function) -> void* {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(function);
+  auto v8_function = v8::internal::Handle<v8::internal::WasmCapiFunction>::cast(v8_object);
+  auto data = v8_function->shared().wasm_capi_function_data().embedder_data();
+  return v8::internal::Managed<HostData>::cast(data).raw()->env;
+}
+
+auto func_call_target(
+  v8::Local<v8::Object> function, v8::Local<v8::Object>* host
+) -> func_target_t {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(function);
+  auto v8_function = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_object);
+  auto isolate = v8_function->GetIsolate();
+  auto instance = v8_function->instance();
+  auto index = v8_function->function_index();
+  if (index >= static_cast<int>(instance.module()->num_imported_functions)) {
+    return TARGET_WASM;
+  }
+
+  // Imports from other instances are entered like local functions.
+  auto ref = instance.imported_function_refs().get(index);
+  if (!ref.IsWasmApiFunctionRef()) return TARGET_WASM;
+  auto callable = v8::internal::WasmApiFunctionRef::cast(ref).callable();
+  if (!v8::internal::WasmCapiFunction::IsWasmCapiFunction(callable)) {
+    return TARGET_JS;
+  }
+  *host = v8::Utils::ToLocal(
+    handle(v8::internal::JSObject::cast(callable), isolate));
+  return TARGET_HOST;
+}
+
+auto func_call_entry(
+  v8::Local<v8::Object> function, char* argv, v8::Local<v8::Value>* exception
+) -> bool {
+  auto v8_object = v8::Utils::OpenHandle<v8::Object, v8::internal::JSReceiver>(function);
+  auto v8_function = v8::internal::Handle<v8::internal::WasmExportedFunction>::cast(v8_object);
+  auto isolate = v8_function->GetIsolate();
+  v8::EscapableHandleScope handle_scope(reinterpret_cast<v8::Isolate*>(isolate));
+  auto function_data = handle(
+    v8_function->shared().wasm_exported_function_data(), isolate);
+  auto instance = handle(function_data->instance(), isolate);
+  auto index = function_data->function_index();
+  auto module = instance->module();
+
+  // Compile the C entry stub on first use.
+  if (function_data->c_wrapper_code() == *BUILTIN_CODE(isolate, Illegal)) {
+    auto sig = module->functions[index].sig;
+    auto wrapper_code = v8::internal::compiler::CompileCWasmEntry(isolate, sig, module);
+    function_data->set_c_wrapper_code(*wrapper_code);
+    function_data->set_packed_args_size(
+      v8::internal::wasm::CWasmArgumentsPacker::TotalSize(sig));
+  }
+  auto wrapper_code = handle(function_data->c_wrapper_code(), isolate);
+  auto call_target = function_data->internal().call_target(isolate);
+
+  v8::internal::Handle<v8::internal::Object> object_ref = instance;
+  if (index < static_cast<int>(module->num_imported_functions)) {
+    object_ref = handle(instance->imported_function_refs().get(index), isolate);
+  }
+
+  v8::internal::Execution::CallWasm(isolate, wrapper_code, call_target,
+    object_ref, reinterpret_cast<v8::internal::Address>(argv));
+
+  if (!isolate->has_pending_exception()) return true;
+  auto v8_exception = handle(isolate->pending_exception(), isolate);
+  isolate->clear_pending_exception();
+  *exception = handle_scope.Escape(v8::Utils::ToLocal(v8_exception));
+  return false;
+}
+
+auto func_slot_size(val_kind_t kind) -> size_t {
+  switch (kind) {
+    case I32: case F32: return 4;
+    case I64: case F64: return 8;
+    case EXTERNREF: case FUNCREF: return sizeof(v8::internal::Address);
+  }
+  UNREACHABLE();
+}
+
+auto func_slot_get_ref(v8::Isolate* isolate, const char* slot) -> v8::Local<v8::Value> {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto raw = v8::base::ReadUnalignedValue<v8::internal::Address>(
+    reinterpret_cast<v8::internal::Address>(slot));
+  auto v8_value = handle(v8::internal::Object(raw), v8_isolate);
+  if (v8_value->IsWasmInternalFunction()) {
+    v8_value = handle(
+      v8::internal::Handle<v8::internal::WasmInternalFunction>::cast(
+        v8_value)->external(), v8_isolate);
+  } else if (v8_value->IsWasmNull()) {
+    v8_value = v8_isolate->factory()->null_value();
+  }
+  return v8::Utils::ToLocal(v8_value);
+}
+
+void func_slot_set_ref(
+  v8::Isolate* isolate, char* slot, val_kind_t kind, v8::Local<v8::Value> value
+) {
+  auto v8_isolate = reinterpret_cast<v8::internal::Isolate*>(isolate);
+  auto v8_value = v8::Utils::OpenHandle<v8::Value, v8::internal::Object>(value);
+  if (kind == FUNCREF) {
+    if (v8_value->IsNull(v8_isolate)) {
+      v8_value = v8_isolate->factory()->wasm_null();
+    } else {
+      v8_value = v8::internal::WasmInternalFunction::FromExternal(
+        v8_value, v8_isolate).ToHandleChecked();
+    }
+  }
+  v8::base::WriteUnalignedValue(
+    reinterpret_cast<v8::internal::Address>(slot), v8_value->ptr());
+}
+
+
 // Globals
 
 auto global_get_i32(v8::Local<v8::Object> global) -> int32_t {
@@ -471,5 +1045,6 @@ auto memory_grow(v8::Local<v8::Object> memory, uint32_t delta) -> bool {
 }  // namespace wasm
 
 template class internal::Managed<wasm::ManagedData>;
+template class internal::Managed<wasm::HostData>;
 
 }  // namespace v8
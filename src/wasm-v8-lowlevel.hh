@@ -7,6 +7,7 @@ namespace v8 {
 namespace wasm {
 
 void flags_init();
+auto flags_hash() -> uint32_t;
 
 auto object_isolate(v8::Local<v8::Object>) -> v8::Isolate*;
 auto object_isolate(const v8::Persistent<v8::Object>&) -> v8::Isolate*;
@@ -30,6 +31,7 @@ auto func_type_param_arity(v8::Local<v8::Object> global) -> uint32_t;
 auto func_type_result_arity(v8::Local<v8::Object> global) -> uint32_t;
 auto func_type_param(v8::Local<v8::Object> global, size_t) -> val_kind_t;
 auto func_type_result(v8::Local<v8::Object> global, size_t) -> val_kind_t;
+auto func_type_index(v8::Local<v8::Object> function) -> uint32_t;
 
 auto global_type_content(v8::Local<v8::Object> global) -> val_kind_t;
 auto global_type_mutable(v8::Local<v8::Object> global) -> bool;
@@ -40,12 +42,46 @@ auto table_type_max(v8::Local<v8::Object> table) -> uint32_t;
 auto memory_type_min(v8::Local<v8::Object> memory) -> uint32_t;
 auto memory_type_max(v8::Local<v8::Object> memory) -> uint32_t;
 
+// Compile and validate directly from the given bytes, without a JS call.
+auto module_compile(v8::Isolate*, const uint8_t*, size_t) -> v8::MaybeLocal<v8::Object>;
+auto module_validate(v8::Isolate*, const uint8_t*, size_t) -> bool;
+// Compiles on background threads. The callback runs from a foreground task,
+// with an empty handle if compilation failed or the isolate is shut down.
+using module_callback_t = void (*)(void* env, v8::Local<v8::Object> module);
+void module_compile_async(v8::Isolate*, const uint8_t*, size_t, module_callback_t, void* env);
 auto module_binary_size(v8::Local<v8::Object> module) -> size_t;
+
+// Streaming compilation completes through tasks posted to the isolate's
+// foreground task runner, so the platform must be pumped until done.
+struct module_streamer_t;
+auto module_streamer_new(v8::Isolate*) -> module_streamer_t*;
+void module_streamer_feed(module_streamer_t*, const uint8_t*, size_t);
+void module_streamer_finish(module_streamer_t*);
+auto module_streamer_done(module_streamer_t*) -> bool;
+auto module_streamer_result(module_streamer_t*) -> v8::MaybeLocal<v8::Object>;
+void module_streamer_delete(module_streamer_t*);
 auto module_binary(v8::Local<v8::Object> module) -> const char*;
 auto module_serialize_size(v8::Local<v8::Object> module) -> size_t;
 auto module_serialize(v8::Local<v8::Object> module, char*, size_t) -> bool;
 auto module_deserialize(v8::Isolate*, const uint8_t*, size_t, const uint8_t*, size_t) -> v8::MaybeLocal<v8::Object>;
-
+// Tiers up all functions on a worker thread of the platform, then passes the
+// wire bytes and the serialized code to the callback on that same thread. The
+// code is null if serialization failed. The task keeps the module's code alive.
+using module_serialized_callback_t = void (*)(void* env,
+  const uint8_t* binary, size_t binary_size, const uint8_t* code, size_t code_size);
+void module_serialize_async(v8::Platform*, v8::Local<v8::Object> module, module_serialized_callback_t, void* env);
+
+// Imports are given in the order of the module's import section. The
+// resulting imports object can be reused for multiple instantiations.
+auto instance_imports(v8::Local<v8::Object> module, const v8::Local<v8::Object> imports[]) -> v8::Local<v8::Object>;
+// The shape of the imports object only depends on the module, so it can be
+// built once as a layout, then filled positionally for each instantiation,
+// without allocating. Clearing drops the imports again.
+auto instance_imports_layout(v8::Local<v8::Object> module) -> v8::Local<v8::Array>;
+auto instance_imports_fill(v8::Local<v8::Array> layout, const v8::Local<v8::Object> imports[]) -> v8::Local<v8::Object>;
+void instance_imports_clear(v8::Local<v8::Array> layout);
+// On failure, returns an empty handle and sets the exception.
+auto instance_new(v8::Local<v8::Object> module, v8::Local<v8::Object> imports, v8::Local<v8::Value>* exception) -> v8::MaybeLocal<v8::Object>;
 auto instance_module(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
 auto instance_exports(v8::Local<v8::Object> instance) -> v8::Local<v8::Object>;
 
@@ -54,6 +90,34 @@ auto extern_kind(v8::Local<v8::Object> external) -> extern_kind_t;
 
 auto func_instance(v8::Local<v8::Function>) -> v8::Local<v8::Object>;
 
+// Host functions receive their arguments packed into argv and write their
+// results back into it. A pending exception is rethrown into Wasm.
+using func_callback_t = void (*)(void* env, char* argv);
+struct func_def_t {
+  const val_kind_t* kinds;  // params followed by results
+  size_t param_arity;
+  size_t result_arity;
+  func_callback_t callback;
+  void* env;
+  void (*finalizer)(void*);
+};
+// Fails before taking ownership of any env, without calling finalizers.
+auto func_new_many(
+  v8::Isolate*, size_t n, const func_def_t[], v8::Local<v8::Function> out[]
+) -> bool;
+auto func_is_host(v8::Local<v8::Object>) -> bool;
+auto func_host_env(v8::Local<v8::Object>) -> void*;
+
+// Exported functions with numeric signatures can be entered directly,
+// with arguments and results packed into argv like for host functions.
+enum func_target_t { TARGET_WASM, TARGET_HOST, TARGET_JS };
+auto func_call_target(v8::Local<v8::Object> function, v8::Local<v8::Object>* host) -> func_target_t;
+auto func_call_entry(v8::Local<v8::Object> function, char* argv, v8::Local<v8::Value>* exception) -> bool;
+
+auto func_slot_size(val_kind_t) -> size_t;
+auto func_slot_get_ref(v8::Isolate*, const char* slot) -> v8::Local<v8::Value>;
+void func_slot_set_ref(v8::Isolate*, char* slot, val_kind_t, v8::Local<v8::Value>);
+
 auto global_get_i32(v8::Local<v8::Object> global) -> int32_t;
 auto global_get_i64(v8::Local<v8::Object> global) -> int64_t;
 auto global_get_f32(v8::Local<v8::Object> global) -> float;
@@ -5,13 +5,26 @@
 #include "v8.h"
 #include "libplatform/libplatform.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <type_traits>
 #include <cstring>
-
-#ifdef WASM_API_DEBUG
+#include <unordered_map>
+#include <vector>
 #include <atomic>
-#endif
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 namespace wasm_v8 {
@@ -55,6 +68,7 @@ struct Stats {
     EXTERNTYPE, IMPORTTYPE, EXPORTTYPE,
     VAL, REF, TRAP,
     MODULE, INSTANCE, FUNC, GLOBAL, TABLE, MEMORY, EXTERN,
+    LINKER, INSTANCEPRE, MODULESTREAMER, STOREPOOL,
     STRONG_COUNT,
     FUNCDATA_FUNCTYPE, FUNCDATA_VALTYPE,
     CATEGORY_COUNT
@@ -87,8 +101,6 @@ struct Stats {
       made[FUNCDATA_VALTYPE][OWN] - freed[FUNCDATA_VALTYPE][OWN];
     freed[VALTYPE][VEC] +=
       made[FUNCDATA_VALTYPE][VEC] - freed[FUNCDATA_VALTYPE][VEC];
-    // Hack for shared modules.
-    freed[BYTE][VEC] += made[MODULE][SHARED] - freed[MODULE][SHARED];
 
     bool leak = false;
     for (int i = 0; i < STRONG_COUNT; ++i) {
@@ -171,7 +183,8 @@ const char* Stats::name[STRONG_COUNT] = {
   "ValType", "FuncType", "GlobalType", "TableType", "MemoryType",
   "ExternType", "ImportType", "ExportType",
   "Val", "Ref", "Trap",
-  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern"
+  "Module", "Instance", "Func", "Global", "Table", "Memory", "Extern",
+  "Linker", "InstancePre", "ModuleStreamer", "StorePool"
 };
 
 const char* Stats::left[CARDINALITY_COUNT] = {
@@ -231,6 +244,9 @@ DEFINE_VEC(Val, vec, VAL)
 // Configuration
 
 struct ConfigImpl : Config {
+  std::string code_cache_dir;
+  vec<byte_t> snapshot = vec<byte_t>::invalid();
+
   ConfigImpl() { stats.make(Stats::CONFIG, this); }
   ~ConfigImpl() { stats.free(Stats::CONFIG, this); }
 };
@@ -246,13 +262,36 @@ auto Config::make() -> own<Config> {
   return own<Config>(new(std::nothrow) ConfigImpl());
 }
 
+void Config::set_code_cache_dir(const std::string& dir) {
+  impl(this)->code_cache_dir = dir;
+}
+
+void Config::set_snapshot(vec<byte_t>&& snapshot) {
+  impl(this)->snapshot = std::move(snapshot);
+}
+
 
 // Engine
 
+struct CompiledCode;
+
 struct EngineImpl : Engine {
   static bool created;
 
   std::unique_ptr<v8::Platform> platform;
+  std::string code_cache_dir;
+  uint64_t code_cache_tag = 0;  // distinguishes V8 versions and flags
+  vec<byte_t> snapshot = vec<byte_t>::invalid();
+  v8::StartupData snapshot_blob = {nullptr, 0};  // points into snapshot
+
+  // Compiled modules by hash of their wire bytes, shared by all stores.
+  std::mutex compiled_mutex;
+  std::unordered_map<uint64_t, std::weak_ptr<CompiledCode>> compiled;
+
+  // Code cache entries still being written from worker threads.
+  std::mutex code_cache_mutex;
+  std::condition_variable code_cache_done;
+  size_t code_cache_pending = 0;
 
   EngineImpl() {
     assert(!created);
@@ -261,6 +300,10 @@ struct EngineImpl : Engine {
   }
 
   ~EngineImpl() {
+    {
+      std::unique_lock<std::mutex> lock(code_cache_mutex);
+      code_cache_done.wait(lock, [this] { return code_cache_pending == 0; });
+    }
     v8::V8::Dispose();
     v8::V8::DisposePlatform();
     stats.free(Stats::ENGINE, this);
@@ -286,6 +329,19 @@ auto Engine::make(own<Config>&& config) -> own<Engine> {
   engine->platform = v8::platform::NewDefaultPlatform();
   v8::V8::InitializePlatform(engine->platform.get());
   v8::V8::Initialize();
+  if (config) {
+    engine->code_cache_dir = impl(config.get())->code_cache_dir;
+    engine->snapshot = std::move(impl(config.get())->snapshot);
+  }
+  if (engine->snapshot) {
+    // Snapshots from other V8 versions are ignored rather than rejected.
+    v8::StartupData blob{engine->snapshot.get(),
+      static_cast<int>(engine->snapshot.size())};
+    if (blob.IsValid()) engine->snapshot_blob = blob;
+  }
+  std::string version(v8::V8::GetVersion());
+  engine->code_cache_tag = wasm::bin::hash(version.data(), version.size()) ^
+    wasm_v8::flags_hash();
   return own<Engine>(engine);
 }
 
@@ -311,44 +367,162 @@ enum v8_function_t {
   V8_F_COUNT,
 };
 
+// Layout of the array holding a store's strings, symbols, functions, and
+// host data map, which snapshots carry over, all but the WebAssembly
+// functions; those are looked up once the store's context exists.
+enum v8_data_t {
+  V8_D_STRINGS = 0,
+  V8_D_SYMBOLS = V8_D_STRINGS + V8_S_COUNT,
+  V8_D_FUNCTIONS = V8_D_SYMBOLS + V8_Y_COUNT,
+  V8_D_WEAKMAP = V8_D_FUNCTIONS + V8_F_COUNT,
+  V8_D_COUNT
+};
+
+// Packed function signatures, shared by all functions of the same type.
+struct FuncSig {
+  size_t param_arity;
+  size_t result_arity;
+  std::unique_ptr<ValKind[]> kinds;  // params followed by results
+  bool numeric = false;
+  size_t packed_size = 0;  // of the argument buffer for direct calls
+
+  auto param(size_t i) const -> ValKind { return kinds[i]; }
+  auto result(size_t i) const -> ValKind { return kinds[param_arity + i]; }
+
+  // Computes the derived fields once the kinds are set.
+  void init() {
+    numeric = true;
+    size_t params_size = 0;
+    size_t results_size = 0;
+    for (size_t i = 0; i < param_arity; ++i) {
+      numeric = numeric && is_num(param(i));
+      params_size += wasm_v8::func_slot_size(
+        static_cast<wasm_v8::val_kind_t>(param(i)));
+    }
+    for (size_t i = 0; i < result_arity; ++i) {
+      numeric = numeric && is_num(result(i));
+      results_size += wasm_v8::func_slot_size(
+        static_cast<wasm_v8::val_kind_t>(result(i)));
+    }
+    packed_size = std::max(params_size, results_size);
+  }
+};
+
+struct StoreImpl;
+
+// Calls queued by Func::call_async, linked into a lock-free stack.
+
+struct AsyncCall {
+  AsyncCall* next;
+  own<Func> func;
+  vec<Val> args;
+  Func::async_callback callback;
+  void* env;
+  Message trap;  // set if the call was rejected when queued
+
+  void run();
+  void cancel();
+};
+
+// Runs the queued calls on the store's thread, from Store::run_pending.
+// Holds the store weakly, since the task may outlive it in the queue.
+class AsyncCallTask : public v8::Task {
+  std::weak_ptr<StoreImpl*> store_;
+
+public:
+  explicit AsyncCallTask(std::weak_ptr<StoreImpl*> store) :
+    store_(std::move(store)) {}
+  void Run() override;
+};
+
 struct StoreImpl : Store {
   friend own<Store> Store::make(Engine*);
 
   v8::Isolate::CreateParams create_params_;
-  v8::Isolate* isolate_;
+  EngineImpl* engine_;
+  v8::Platform* platform_;
+  v8::Isolate* isolate_ = nullptr;
   v8::Eternal<v8::Context> context_;
   v8::Eternal<v8::String> strings_[V8_S_COUNT];
   v8::Eternal<v8::Symbol> symbols_[V8_Y_COUNT];
   v8::Eternal<v8::Function> functions_[V8_F_COUNT];
   v8::Eternal<v8::Object> host_data_map_;
   v8::Eternal<v8::Symbol> callback_symbol_;
+  v8::Eternal<v8::Private> module_data_key_;
+  v8::Eternal<v8::Private> export_table_key_;
+  v8::Eternal<v8::Private> imports_layout_key_;
   v8::Persistent<v8::Object>* handle_pool_ = nullptr;  // TODO: use v8::Value
+  size_t live_handles_ = 0;
+  std::unordered_map<uint32_t, std::unique_ptr<FuncSig>> func_sigs_;
+  std::unordered_map<uint32_t, v8::Eternal<v8::Object>> wrapper_modules_;
+  size_t wrapper_hits_ = 0;
+  size_t wrapper_misses_ = 0;
+  std::shared_ptr<v8::TaskRunner> task_runner_;
+  std::atomic<AsyncCall*> async_calls_{nullptr};
+  size_t completions_ = 0;
+  // Liveness token for tasks, which are only run on the store's thread.
+  std::shared_ptr<StoreImpl*> self_ = std::make_shared<StoreImpl*>(this);
 
   StoreImpl() {
     stats.make(Stats::STORE, this);
   }
 
   ~StoreImpl() {
+    cancel_async();
+    self_.reset();
+    if (isolate_) {
+      {
+        // Run what is left in the isolate's task queue, so that the queue is
+        // empty when the platform forgets it.
+        v8::Isolate::Scope isolate_scope(isolate_);
+        while (v8::platform::PumpMessageLoop(platform_, isolate_)) {}
 #ifdef WASM_API_DEBUG
-    isolate_->RequestGarbageCollectionForTesting(
-      v8::Isolate::kFullGarbageCollection);
+        isolate_->RequestGarbageCollectionForTesting(
+          v8::Isolate::kFullGarbageCollection);
 #endif
-    {
-      v8::HandleScope scope(isolate_);
-      while (handle_pool_ != nullptr) {
-        auto handle = handle_pool_;
-        handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
-          wasm_v8::foreign_get(handle->Get(isolate_)));
-        delete handle;
+        v8::HandleScope scope(isolate_);
+        while (handle_pool_ != nullptr) {
+          auto handle = handle_pool_;
+          handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
+            wasm_v8::foreign_get(handle->Get(isolate_)));
+          delete handle;
+        }
       }
+      isolate_->Dispose();
+      v8::platform::NotifyIsolateShutdown(platform_, isolate_);
     }
-    context()->Exit();
-    isolate_->Exit();
-    isolate_->Dispose();
     delete create_params_.array_buffer_allocator;
     stats.free(Stats::STORE, this);
   }
 
+  // False while the store is being deleted.
+  auto alive() const -> bool {
+    return self_ != nullptr;
+  }
+
+  auto engine() const -> EngineImpl* {
+    return engine_;
+  }
+
+  // Number of references into the store that have not been destroyed yet.
+  auto live_handles() const -> size_t {
+    return live_handles_;
+  }
+
+  // Objects other than references that keep V8 handles into the store
+  // count as live as well, so that the store is not reset under them.
+  void retain_handle() {
+    ++live_handles_;
+  }
+
+  void release_handle() {
+    --live_handles_;
+  }
+
+  auto platform() const -> v8::Platform* {
+    return platform_;
+  }
+
   auto isolate() const -> v8::Isolate* {
     return isolate_;
   }
@@ -371,6 +545,18 @@ struct StoreImpl : Store {
     return host_data_map_.Get(isolate_);
   }
 
+  auto module_data_key() const -> v8::Local<v8::Private> {
+    return module_data_key_.Get(isolate_);
+  }
+
+  auto export_table_key() const -> v8::Local<v8::Private> {
+    return export_table_key_.Get(isolate_);
+  }
+
+  auto imports_layout_key() const -> v8::Local<v8::Private> {
+    return imports_layout_key_.Get(isolate_);
+  }
+
   static auto get(v8::Isolate* isolate) -> StoreImpl* {
     return static_cast<StoreImpl*>(isolate->GetData(0));
   }
@@ -388,126 +574,433 @@ struct StoreImpl : Store {
     auto handle = handle_pool_;
     handle_pool_ = reinterpret_cast<v8::Persistent<v8::Object>*>(
       wasm_v8::foreign_get(handle->Get(isolate_)));
+    ++live_handles_;
     return handle;
   }
 
   void free_handle(v8::Persistent<v8::Object>* handle) {
     // TODO: shrink pool?
+    --live_handles_;
     auto next = wasm_v8::foreign_new(isolate_, handle_pool_);
     handle->Reset(isolate_, v8::Local<v8::Object>::Cast(next));
     handle_pool_ = handle;
   }
+
+  // Completions are delivered through tasks on the isolate's foreground
+  // task runner, which the embedder pumps in Store::run_pending.
+  void post_task(std::unique_ptr<v8::Task> task) {
+    task_runner_->PostTask(std::move(task));
+  }
+
+  void count_completions(size_t n) {
+    completions_ += n;
+  }
+
+  // May be called from any thread. A task is only posted for the first call
+  // pushed onto an empty queue; it runs all calls queued by then.
+  void push_async(AsyncCall* call) {
+    auto head = async_calls_.load();
+    do {
+      call->next = head;
+    } while (!async_calls_.compare_exchange_weak(head, call));
+    if (head == nullptr) post_task(std::make_unique<AsyncCallTask>(self_));
+  }
+
+  // Takes all queued calls, in the order they were pushed.
+  auto take_async() -> AsyncCall* {
+    auto head = async_calls_.exchange(nullptr);
+    AsyncCall* calls = nullptr;
+    while (head != nullptr) {
+      auto next = head->next;
+      head->next = calls;
+      calls = head;
+      head = next;
+    }
+    return calls;
+  }
+
+  void cancel_async() {
+    for (auto call = take_async(); call != nullptr;) {
+      auto next = call->next;
+      call->cancel();
+      delete call;
+      call = next;
+    }
+  }
+
+  // Returns null if allocating the signature fails; no entry is left behind
+  // in that case, so a later call retries.
+  auto func_sig(v8::Local<v8::Object> function) -> const FuncSig* {
+    auto index = wasm_v8::func_type_index(function);
+    auto& sig = func_sigs_[index];
+    if (sig) return sig.get();
+
+    auto param_arity = wasm_v8::func_type_param_arity(function);
+    auto result_arity = wasm_v8::func_type_result_arity(function);
+    auto kinds = std::unique_ptr<ValKind[]>(
+      new(std::nothrow) ValKind[param_arity + result_arity]);
+    if (!kinds) {
+      func_sigs_.erase(index);
+      return nullptr;
+    }
+    for (size_t i = 0; i < param_arity; ++i) {
+      kinds[i] = static_cast<ValKind>(wasm_v8::func_type_param(function, i));
+    }
+    for (size_t i = 0; i < result_arity; ++i) {
+      kinds[param_arity + i] =
+        static_cast<ValKind>(wasm_v8::func_type_result(function, i));
+    }
+    sig.reset(new(std::nothrow)
+      FuncSig{param_arity, result_arity, std::move(kinds)});
+    if (!sig) {
+      func_sigs_.erase(index);
+      return nullptr;
+    }
+    sig->init();
+    return sig.get();
+  }
 };
 
 template<> struct implement<Store> { using type = StoreImpl; };
 
+// Enters a store's isolate and context for the duration of an API call.
+// Stores are not left entered between calls, since isolates have to be
+// exited in the reverse order of entering them, and stores can be created
+// and deleted in any order.
+class StoreScope {
+  v8::Isolate::Scope isolate_scope_;
+  v8::HandleScope handle_scope_;
+  v8::Context::Scope context_scope_;
+
+public:
+  explicit StoreScope(v8::Isolate* isolate) :
+    isolate_scope_(isolate), handle_scope_(isolate),
+    context_scope_(StoreImpl::get(isolate)->context()) {}
+};
+
 
 void Store::destroy() {
   delete impl(this);
 }
 
-auto Store::make(Engine*) -> own<Store> {
+auto Store::wrapper_cache_hits() const -> size_t {
+  return impl(this)->wrapper_hits_;
+}
+
+auto Store::wrapper_cache_misses() const -> size_t {
+  return impl(this)->wrapper_misses_;
+}
+
+void AsyncCallTask::Run() {
+  auto self = store_.lock();
+  if (!self) return;
+  auto store = *self;
+  size_t count = 0;
+  for (auto call = store->take_async(); call != nullptr; ++count) {
+    auto next = call->next;
+    call->run();
+    delete call;
+    call = next;
+  }
+  store->count_completions(count);
+}
+
+auto Store::run_pending(bool wait) -> size_t {
+  auto store = impl(this);
+  StoreScope store_scope(store->isolate());
+  auto completions = store->completions_;
+  auto behavior = wait
+    ? v8::platform::MessageLoopBehavior::kWaitForWork
+    : v8::platform::MessageLoopBehavior::kDoNotWait;
+  while (v8::platform::PumpMessageLoop(
+      store->platform(), store->isolate(), behavior)) {
+    behavior = v8::platform::MessageLoopBehavior::kDoNotWait;
+  }
+  return store->completions_ - completions;
+}
+
+auto Store::reset() -> bool {
+  auto store = impl(this);
+  // Resetting does not drop anything, live references would keep their
+  // objects and see them in a reused store.
+  if (store->live_handles() > 0) return false;
+  auto isolate = store->isolate();
+  StoreScope store_scope(isolate);
+  store->cancel_async();
+  while (v8::platform::PumpMessageLoop(store->platform(), isolate)) {}
+  store->completions_ = 0;
+  isolate->CancelTerminateExecution();
+  // Objects are only reachable through references, which are all gone, so
+  // a full collection frees them and runs their host info finalizers.
+  isolate->LowMemoryNotification();
+  return true;
+}
+
+// Looks up the named functions on carrier into slots [first, last) of data.
+auto store_data_functions(
+  v8::Isolate* isolate, v8::Local<v8::Context> context,
+  v8::Local<v8::Array> data, v8::Local<v8::Object> carrier,
+  const char* const names[], int first, int last
+) -> bool {
+  for (int i = first; i < last; ++i) {
+    auto maybe_name = v8::String::NewFromUtf8(isolate, names[i - first],
+      v8::NewStringType::kNormal);
+    if (maybe_name.IsEmpty()) return false;
+    auto maybe_obj = carrier->Get(context, maybe_name.ToLocalChecked());
+    if (maybe_obj.IsEmpty()) return false;
+    auto value = maybe_obj.ToLocalChecked();
+    if (!value->IsFunction()) return false;
+    ignore(data->Set(context, V8_D_FUNCTIONS + i, value));
+  }
+  return true;
+}
+
+// Creates the per-store values that Store::make keeps as eternal handles,
+// laid out as described by v8_data_t, except for the WebAssembly functions.
+// Also used to build snapshots, whose contexts lack WebAssembly, since V8
+// does not install it while serializing.
+auto store_data_new(v8::Isolate* isolate, v8::Local<v8::Context> context)
+-> v8::MaybeLocal<v8::Array> {
+  auto data = v8::Array::New(isolate, V8_D_COUNT);
+
+  // Create strings.
+  static const char* const raw_strings[V8_S_COUNT] = {
+    "",
+    "i32", "i64", "f32", "f64", "externref", "funcref",
+    "value", "mutable", "element", "initial", "maximum",
+  };
+  for (int i = 0; i < V8_S_COUNT; ++i) {
+    auto maybe = v8::String::NewFromUtf8(isolate, raw_strings[i],
+      v8::NewStringType::kNormal);
+    if (maybe.IsEmpty()) return {};
+    ignore(data->Set(context, V8_D_STRINGS + i, maybe.ToLocalChecked()));
+  }
+
+  for (int i = 0; i < V8_Y_COUNT; ++i) {
+    ignore(data->Set(context, V8_D_SYMBOLS + i, v8::Symbol::New(isolate)));
+  }
+
+  // Extract WeakMap functions.
+  auto global = context->Global();
+  static const char* const weakmap_names[] = {"WeakMap"};
+  static const char* const weakmap_proto_names[] = {"get", "set"};
+  if (!store_data_functions(isolate, context, data, global,
+        weakmap_names, V8_F_WEAKMAP, V8_F_WEAKMAP_PROTO)) {
+    return {};
+  }
+  auto weakmap = data->Get(context, V8_D_FUNCTIONS + V8_F_WEAKMAP)
+    .ToLocalChecked().As<v8::Function>();
+  auto maybe_proto_name = v8::String::NewFromUtf8(isolate, "prototype",
+    v8::NewStringType::kNormal);
+  if (maybe_proto_name.IsEmpty()) return {};
+  auto maybe_proto = weakmap->Get(context, maybe_proto_name.ToLocalChecked());
+  if (maybe_proto.IsEmpty() || !maybe_proto.ToLocalChecked()->IsObject()) {
+    return {};
+  }
+  auto weakmap_proto = maybe_proto.ToLocalChecked().As<v8::Object>();
+  if (!store_data_functions(isolate, context, data, weakmap_proto,
+        weakmap_proto_names, V8_F_WEAKMAP_GET, V8_F_MODULE)) {
+    return {};
+  }
+
+  // Create host data weak map.
+  v8::Local<v8::Value> empty_args[] = {};
+  auto maybe_weakmap = weakmap->NewInstance(context, 0, empty_args);
+  if (maybe_weakmap.IsEmpty()) return {};
+  auto map = v8::Local<v8::Object>::Cast(maybe_weakmap.ToLocalChecked());
+  assert(map->IsWeakMap());
+  ignore(data->Set(context, V8_D_WEAKMAP, map));
+
+  return data;
+}
+
+// Adds the WebAssembly functions to data, once the store's context exists.
+// Without WebAssembly installed in the context, stores would be unusable,
+// so fail rather than leave slots empty.
+auto store_data_add_wasm(
+  v8::Isolate* isolate, v8::Local<v8::Context> context, v8::Local<v8::Array> data
+) -> bool {
+  auto maybe_wasm_name = v8::String::NewFromUtf8(isolate, "WebAssembly",
+      v8::NewStringType::kNormal);
+  if (maybe_wasm_name.IsEmpty()) return false;
+  auto maybe_wasm = context->Global()->Get(context,
+    maybe_wasm_name.ToLocalChecked());
+  if (maybe_wasm.IsEmpty() || !maybe_wasm.ToLocalChecked()->IsObject()) {
+    return false;
+  }
+  auto wasm = maybe_wasm.ToLocalChecked().As<v8::Object>();
+  static const char* const wasm_names[] = {
+    "Module", "Global", "Table", "Memory", "Instance", "validate",
+  };
+  return store_data_functions(isolate, context, data, wasm,
+    wasm_names, V8_F_MODULE, V8_F_COUNT);
+}
+
+auto Engine::make_snapshot() const -> vec<byte_t> {
+  v8::StartupData blob;
+  {
+    v8::SnapshotCreator creator;
+    auto isolate = creator.GetIsolate();
+    {
+      v8::HandleScope handle_scope(isolate);
+      auto context = v8::Context::New(isolate);
+      if (context.IsEmpty()) return vec<byte_t>::invalid();
+      v8::Context::Scope context_scope(context);
+      auto maybe_data = store_data_new(isolate, context);
+      if (maybe_data.IsEmpty()) return vec<byte_t>::invalid();
+      creator.AddData(context, maybe_data.ToLocalChecked());
+      creator.SetDefaultContext(context);
+    }
+    blob = creator.CreateBlob(
+      v8::SnapshotCreator::FunctionCodeHandling::kKeep);
+  }
+  if (!blob.data) return vec<byte_t>::invalid();
+  auto snapshot = vec<byte_t>::make_uninitialized(blob.raw_size);
+  if (snapshot) std::memcpy(snapshot.get(), blob.data, blob.raw_size);
+  delete[] blob.data;
+  return snapshot;
+}
+
+auto Store::make(Engine* engine) -> own<Store> {
   auto store = own<StoreImpl>(new(std::nothrow) StoreImpl());
   if (!store) return own<Store>();
+  store->engine_ = impl(engine);
+  store->platform_ = impl(engine)->platform.get();
 
   // Create isolate.
   store->create_params_.array_buffer_allocator =
     v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+  auto snapshot = impl(engine)->snapshot_blob.data != nullptr;
+  if (snapshot) store->create_params_.snapshot_blob = &impl(engine)->snapshot_blob;
   auto isolate = v8::Isolate::New(store->create_params_);
   if (!isolate) return own<Store>();
+  store->isolate_ = isolate;
 
   {
     v8::Isolate::Scope isolate_scope(isolate);
     v8::HandleScope handle_scope(isolate);
 
-    // Create context.
+    // Create context, which is deserialized if there is a snapshot.
     auto context = v8::Context::New(isolate);
     if (context.IsEmpty()) return own<Store>();
     v8::Context::Scope context_scope(context);
 
-    store->isolate_ = isolate;
     store->context_ = v8::Eternal<v8::Context>(isolate, context);
 
-    // Create strings.
-    static const char* const raw_strings[V8_S_COUNT] = {
-      "",
-      "i32", "i64", "f32", "f64", "externref", "funcref",
-      "value", "mutable", "element", "initial", "maximum",
+    // Create strings, symbols, functions, and the host data weak map, or
+    // take them from the snapshot, then add the WebAssembly functions.
+    auto maybe_data = snapshot
+      ? context->GetDataFromSnapshotOnce<v8::Array>(0)
+      : store_data_new(isolate, context);
+    if (maybe_data.IsEmpty()) return own<Store>();
+    auto data = maybe_data.ToLocalChecked();
+    if (!store_data_add_wasm(isolate, context, data)) return own<Store>();
+    auto get = [&](uint32_t i) -> v8::Local<v8::Value> {
+      auto maybe = data->Get(context, i);
+      return maybe.IsEmpty() ? v8::Local<v8::Value>() : maybe.ToLocalChecked();
     };
     for (int i = 0; i < V8_S_COUNT; ++i) {
-      auto maybe = v8::String::NewFromUtf8(isolate, raw_strings[i],
-        v8::NewStringType::kNormal);
-      if (maybe.IsEmpty()) return own<Store>();
-      auto string = maybe.ToLocalChecked();
-      store->strings_[i] = v8::Eternal<v8::String>(isolate, string);
+      auto value = get(V8_D_STRINGS + i);
+      if (value.IsEmpty() || !value->IsString()) return own<Store>();
+      store->strings_[i] =
+        v8::Eternal<v8::String>(isolate, value.As<v8::String>());
     }
-
     for (int i = 0; i < V8_Y_COUNT; ++i) {
-      auto symbol = v8::Symbol::New(isolate);
-      store->symbols_[i] = v8::Eternal<v8::Symbol>(isolate, symbol);
-    }
-
-    // Extract functions.
-    auto global = context->Global();
-    auto maybe_wasm_name = v8::String::NewFromUtf8(isolate, "WebAssembly",
-        v8::NewStringType::kNormal);
-    if (maybe_wasm_name.IsEmpty()) return own<Store>();
-    auto wasm_name = maybe_wasm_name.ToLocalChecked();
-    auto maybe_wasm = global->Get(context, wasm_name);
-    if (maybe_wasm.IsEmpty()) return own<Store>();
-    auto wasm = v8::Local<v8::Object>::Cast(maybe_wasm.ToLocalChecked());
-    v8::Local<v8::Object> weakmap;
-    v8::Local<v8::Object> weakmap_proto;
-
-    struct {
-      const char* name;
-      v8::Local<v8::Object>* carrier;
-    } raw_functions[V8_F_COUNT] = {
-      {"WeakMap", &global}, {"prototype", &weakmap},
-      {"get", &weakmap_proto}, {"set", &weakmap_proto},
-      {"Module", &wasm}, {"Global", &wasm}, {"Table", &wasm}, {"Memory", &wasm},
-      {"Instance", &wasm}, {"validate", &wasm},
-    };
+      auto value = get(V8_D_SYMBOLS + i);
+      if (value.IsEmpty() || !value->IsSymbol()) return own<Store>();
+      store->symbols_[i] =
+        v8::Eternal<v8::Symbol>(isolate, value.As<v8::Symbol>());
+    }
     for (int i = 0; i < V8_F_COUNT; ++i) {
-      auto maybe_name = v8::String::NewFromUtf8(isolate, raw_functions[i].name,
-        v8::NewStringType::kNormal);
-      if (maybe_name.IsEmpty()) return own<Store>();
-      auto name = maybe_name.ToLocalChecked();
-      assert(!raw_functions[i].carrier->IsEmpty());
-      // TODO(wasm+): remove
-      if ((*raw_functions[i].carrier)->IsUndefined()) continue;
-      auto maybe_obj = (*raw_functions[i].carrier)->Get(context, name);
-      if (maybe_obj.IsEmpty()) return own<Store>();
-      auto obj = v8::Local<v8::Object>::Cast(maybe_obj.ToLocalChecked());
-      if (i == V8_F_WEAKMAP_PROTO) {
-        assert(obj->IsObject());
-        weakmap_proto = obj;
-      } else {
-        assert(obj->IsFunction());
-        auto function = v8::Local<v8::Function>::Cast(obj);
-        store->functions_[i] = v8::Eternal<v8::Function>(isolate, function);
-        if (i == V8_F_WEAKMAP) weakmap = function;
-      }
+      auto value = get(V8_D_FUNCTIONS + i);
+      // The prototype is only needed while creating the data.
+      if (i == V8_F_WEAKMAP_PROTO) continue;
+      if (value.IsEmpty() || !value->IsFunction()) return own<Store>();
+      store->functions_[i] =
+        v8::Eternal<v8::Function>(isolate, value.As<v8::Function>());
     }
-
-    // Create host data weak map.
-    v8::Local<v8::Value> empty_args[] = {};
-    auto maybe_weakmap =
-      store->v8_function(V8_F_WEAKMAP)->NewInstance(context, 0, empty_args);
-    if (maybe_weakmap.IsEmpty()) return own<Store>();
-    auto map = v8::Local<v8::Object>::Cast(maybe_weakmap.ToLocalChecked());
-    assert(map->IsWeakMap());
-    store->host_data_map_ = v8::Eternal<v8::Object>(isolate, map);
+    auto map = get(V8_D_WEAKMAP);
+    if (map.IsEmpty() || !map->IsWeakMap()) return own<Store>();
+    store->host_data_map_ =
+      v8::Eternal<v8::Object>(isolate, map.As<v8::Object>());
+
+    store->module_data_key_ =
+      v8::Eternal<v8::Private>(isolate, v8::Private::New(isolate));
+    store->export_table_key_ =
+      v8::Eternal<v8::Private>(isolate, v8::Private::New(isolate));
+    store->imports_layout_key_ =
+      v8::Eternal<v8::Private>(isolate, v8::Private::New(isolate));
   }
 
-  store->isolate()->Enter();
-  store->context()->Enter();
   isolate->SetData(0, store.get());
+  store->task_runner_ = store->platform()->GetForegroundTaskRunner(isolate);
 
   return store;
 };
 
 
+// Store pools
+
+struct StorePoolImpl : StorePool {
+  EngineImpl* engine;
+  size_t capacity;
+  std::vector<own<Store>> idle;
+
+  StorePoolImpl(EngineImpl* engine, size_t capacity)
+    : engine(engine), capacity(capacity) {
+    stats.make(Stats::STOREPOOL, this);
+  }
+
+  ~StorePoolImpl() {
+    stats.free(Stats::STOREPOOL, this);
+  }
+};
+
+template<> struct implement<StorePool> { using type = StorePoolImpl; };
+
+
+void StorePool::destroy() {
+  delete impl(this);
+}
+
+auto StorePool::make(Engine* engine, size_t capacity, size_t warm)
+-> own<StorePool> {
+  auto pool = own<StorePoolImpl>(
+    new(std::nothrow) StorePoolImpl(impl(engine), capacity));
+  if (!pool) return own<StorePool>();
+  pool->idle.reserve(capacity);
+  for (size_t i = 0; i < warm && i < capacity; ++i) {
+    auto store = Store::make(engine);
+    if (!store) return own<StorePool>();
+    pool->idle.push_back(std::move(store));
+  }
+  return pool;
+}
+
+auto StorePool::acquire() -> own<Store> {
+  auto pool = impl(this);
+  if (pool->idle.empty()) return Store::make(pool->engine);
+  auto store = std::move(pool->idle.back());
+  pool->idle.pop_back();
+  return store;
+}
+
+void StorePool::release(own<Store>&& store) {
+  auto pool = impl(this);
+  if (!store) return;
+  // A store that is still referenced cannot be reset for reuse.
+  if (pool->idle.size() >= pool->capacity || !store->reset()) {
+    store.reset();
+    return;
+  }
+  pool->idle.push_back(std::move(store));
+}
+
+auto StorePool::idle_count() const -> size_t {
+  return impl(this)->idle.size();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Type Representations
 
@@ -1011,22 +1504,32 @@ struct RefImpl : Ref, v8::Persistent<v8::Object> {
   RefImpl() = default;
   ~RefImpl() {
     stats.free(Stats::categorize(*this), this);
-    v8::HandleScope handle_scope(this->isolate());
+    StoreScope store_scope(this->isolate());
     this->store()->free_handle(this);
   }
 
   static auto make(StoreImpl* store, v8::Local<v8::Object> obj) -> own<Ref> {
     static_assert(sizeof(RefImpl) == sizeof(v8::Persistent<v8::Object>),
       "incompatible object layout");
-    auto self = static_cast<RefImpl*>(store->make_handle());
-    if (!self) return nullptr;
+    auto handle = store->make_handle();
+    if (!handle) return nullptr;
+    return make(store, handle, obj);
+  }
+
+  // Takes a handle from StoreImpl::make_handle, so that it can be reserved
+  // before a point where failure is no longer an option.
+  static auto make(
+    StoreImpl* store, v8::Persistent<v8::Object>* handle,
+    v8::Local<v8::Object> obj
+  ) -> own<Ref> {
+    auto self = static_cast<RefImpl*>(handle);
     self->Reset(store->isolate(), obj);
     stats.make(Stats::categorize(*self), self);
     return own<Ref>(self);
   }
 
   auto copy() const -> own<Ref> {
-    v8::HandleScope handle_scope(isolate());
+    StoreScope store_scope(isolate());
     return make(store(), v8_object());
   }
 
@@ -1043,7 +1546,7 @@ struct RefImpl : Ref, v8::Persistent<v8::Object> {
   }
 
   auto get_host_info() const -> void* {
-    v8::HandleScope handle_scope(isolate());
+    StoreScope store_scope(isolate());
     auto store = this->store();
 
     v8::Local<v8::Value> args[] = { v8_object() };
@@ -1054,7 +1557,7 @@ struct RefImpl : Ref, v8::Persistent<v8::Object> {
   }
 
   void set_host_info(void* info, void (*finalizer)(void*)) {
-    v8::HandleScope handle_scope(isolate());
+    StoreScope store_scope(isolate());
     auto store = this->store();
     auto managed = wasm_v8::managed_new(store->isolate(), info, finalizer);
     v8::Local<v8::Value> args[] = { v8_object(), managed };
@@ -1087,7 +1590,7 @@ auto Ref::copy() const -> own<Ref> {
 }
 
 auto Ref::same(const Ref* that) const -> bool {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return impl(this)->v8_object()->SameValue(impl(that)->v8_object());
 }
 
@@ -1135,10 +1638,10 @@ auto v8_to_ref(StoreImpl* store, v8::Local<v8::Value> value) -> own<Ref> {
 }
 
 auto v8_to_val(
-  StoreImpl* store, v8::Local<v8::Value> value, const ValType* t
+  StoreImpl* store, v8::Local<v8::Value> value, ValKind kind
 ) -> Val {
   auto context = store->context();
-  switch (t->kind()) {
+  switch (kind) {
     case ValKind::I32: return Val(value->Int32Value(context).ToChecked());
     case ValKind::I64: {
       auto bigint = value->ToBigInt(context).ToLocalChecked();
@@ -1156,6 +1659,38 @@ auto v8_to_val(
   }
 }
 
+auto raw_to_v8(
+  StoreImpl* store, uint64_t raw, ValKind kind
+) -> v8::Local<v8::Value> {
+  auto isolate = store->isolate();
+  switch (kind) {
+    case ValKind::I32: return v8::Integer::New(isolate, raw_decode<int32_t>(raw));
+    case ValKind::I64: return v8::BigInt::New(isolate, raw_decode<int64_t>(raw));
+    case ValKind::F32: return v8::Number::New(isolate, raw_decode<float32_t>(raw));
+    case ValKind::F64: return v8::Number::New(isolate, raw_decode<float64_t>(raw));
+    default: assert(false);
+  }
+}
+
+auto v8_to_raw(
+  StoreImpl* store, v8::Local<v8::Value> value, ValKind kind
+) -> uint64_t {
+  auto context = store->context();
+  switch (kind) {
+    case ValKind::I32: return raw_encode(value->Int32Value(context).ToChecked());
+    case ValKind::I64: {
+      auto bigint = value->ToBigInt(context).ToLocalChecked();
+      return raw_encode(bigint->Int64Value());
+    }
+    case ValKind::F32: {
+      auto number = value->NumberValue(context).ToChecked();
+      return raw_encode(static_cast<float32_t>(number));
+    }
+    case ValKind::F64: return raw_encode(value->NumberValue(context).ToChecked());
+    default: assert(false);
+  }
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Runtime Objects
@@ -1230,7 +1765,7 @@ auto Trap::copy() const -> own<Trap> {
 auto Trap::make(Store* store_abs, const Message& message) -> own<Trap> {
   auto store = impl(store_abs);
   v8::Isolate* isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
 
   auto maybe_string = v8::String::NewFromUtf8(isolate, message.get(),
     v8::NewStringType::kNormal, message.size());
@@ -1241,7 +1776,7 @@ auto Trap::make(Store* store_abs, const Message& message) -> own<Trap> {
 
 auto Trap::message() const -> Message {
   auto isolate = impl(this)->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
 
   auto message = v8::Exception::CreateMessage(isolate, impl(this)->v8_object());
   v8::String::Utf8Value string(isolate, message->Get());
@@ -1275,7 +1810,7 @@ auto Foreign::copy() const -> own<Foreign> {
 auto Foreign::make(Store* store_abs) -> own<Foreign> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
 
   auto obj = v8::Object::New(isolate);
   return RefImpl<Foreign>::make(store, obj);
@@ -1298,124 +1833,320 @@ auto Module::copy() const -> own<Module> {
 auto Module::validate(Store* store_abs, const vec<byte_t>& binary) -> bool {
   auto store = impl(store_abs);
   v8::Isolate* isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
-
-  auto array_buffer = v8::ArrayBuffer::New(isolate, binary.size());
-  memcpy(array_buffer->GetBackingStore()->Data(),
-    binary.get(), binary.size());
+  StoreScope store_scope(isolate);
+  return wasm_v8::module_validate(isolate,
+    reinterpret_cast<const uint8_t*>(binary.get()), binary.size());
+}
+
+// Import and export types are decoded once per module object and attached
+// to it, since instantiation and export lookup need them every time.
+
+// An entry in the engine's table of compiled modules. Modules created from
+// it keep it alive, and it removes itself once the last one is collected.
+struct CompiledCode {
+  EngineImpl* engine;
+  uint64_t hash;
+  v8::CompiledWasmModule compiled;
+
+  ~CompiledCode() {
+    std::lock_guard<std::mutex> lock(engine->compiled_mutex);
+    auto it = engine->compiled.find(hash);
+    if (it != engine->compiled.end() && it->second.expired()) {
+      engine->compiled.erase(it);
+    }
+  }
+};
 
-  v8::Local<v8::Value> args[] = {array_buffer};
-  auto result = store->v8_function(V8_F_VALIDATE)->Call(
-    store->context(), v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return false;
+struct ModuleData {
+  ownvec<ImportType> imports;
+  ownvec<ExportType> exports;
+  std::unordered_map<std::string_view, size_t> export_indices;
+  uint64_t hash;
+  std::shared_ptr<CompiledCode> code;
+};
 
-  return result.ToLocalChecked()->IsTrue();
+void finalize_module_data(void* data) {
+  delete static_cast<ModuleData*>(data);
 }
 
-auto Module::make(Store* store_abs, const vec<byte_t>& binary) -> own<Module> {
-  auto store = impl(store_abs);
-  auto isolate = store->isolate();
+// Returns the module's cached metadata, creating it on first use. Modules
+// from the engine's table pass their entry, which also provides the hash.
+auto module_data(
+  StoreImpl* store, v8::Local<v8::Object> module,
+  std::shared_ptr<CompiledCode> code = nullptr
+) -> const ModuleData* {
   auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
-
-  auto array_buffer = v8::ArrayBuffer::New(isolate, binary.size());
-  memcpy(array_buffer->GetBackingStore()->Data(),
-    binary.get(), binary.size());
-
-  v8::Local<v8::Value> args[] = {array_buffer};
-  auto maybe_obj =
-    store->v8_function(V8_F_MODULE)->NewInstance(context, 1, args);
-  if (maybe_obj.IsEmpty()) return nullptr;
-  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
-}
+  auto key = store->module_data_key();
+  auto maybe_value = module->GetPrivate(context, key);
+  if (!maybe_value.IsEmpty()) {
+    auto value = maybe_value.ToLocalChecked();
+    if (!value->IsUndefined()) {
+      return static_cast<ModuleData*>(wasm_v8::managed_get(value));
+    }
+  }
 
-auto Module::imports() const -> ownvec<ImportType> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto module = impl(this)->v8_object();
   auto binary = vec<byte_t>::adopt(
     wasm_v8::module_binary_size(module),
     const_cast<byte_t*>(wasm_v8::module_binary(module))
   );
-  auto imports = wasm::bin::imports(binary);
+  auto data = new(std::nothrow) ModuleData{
+    wasm::bin::imports(binary), wasm::bin::exports(binary), {},
+    code ? code->hash : wasm::bin::hash(binary.get(), binary.size()),
+    std::move(code)};
   binary.release();
-  return imports;
-  // return impl(this)->data->imports.copy();
-/* OBSOLETE?
-  auto store = module->store();
-  auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+  if (!data) return nullptr;
+  for (size_t i = 0; i < data->exports.size(); ++i) {
+    auto& name = data->exports[i]->name();
+    data->export_indices.emplace(std::string_view(name.get(), name.size()), i);
+  }
+  auto managed = wasm_v8::managed_new(
+    store->isolate(), data, &finalize_module_data);
+  ignore(module->SetPrivate(context, key, managed));
+  return data;
+}
+
+
+
+// Code cache
+
+// Cache files hold the same format as Module::serialize, i.e., the wire bytes
+// prefixed by their size, followed by V8's serialized code. The file name
+// combines a hash of the wire bytes with a hash of the V8 version and flags,
+// and the wire bytes are compared on load to rule out hash collisions.
+
+auto code_cache_path(EngineImpl* engine, uint64_t hash) -> std::string {
+  char name[48];
+  snprintf(name, sizeof(name), "/%016" PRIx64 "-%016" PRIx64 ".wasmcache",
+    hash, engine->code_cache_tag);
+  return engine->code_cache_dir + name;
+}
+
+auto code_cache_load(
+  StoreImpl* store, const std::string& path, const vec<byte_t>& binary
+) -> v8::MaybeLocal<v8::Object> {
+  v8::MaybeLocal<v8::Object> result;
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return result;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return result; }
+  auto file_size = static_cast<size_t>(st.st_size);
+  auto data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) return result;
+
+  // Compare the length prefix against its expected encoding rather than
+  // decoding it, so that a corrupt prefix cannot be read past the mapping.
+  auto begin = static_cast<const byte_t*>(data);
+  byte_t prefix[10];
+  auto prefix_end = prefix;
+  wasm::bin::encode_u64(prefix_end, binary.size());
+  auto size_size = static_cast<size_t>(prefix_end - prefix);
+  if (file_size > size_size + binary.size()) {
+    auto ptr = begin + size_size;
+    if (std::memcmp(begin, prefix, size_size) == 0 &&
+        std::memcmp(ptr, binary.get(), binary.size()) == 0) {
+      auto ptr2 = reinterpret_cast<const uint8_t*>(ptr);
+      result = wasm_v8::module_deserialize(store->isolate(),
+        ptr2, binary.size(), ptr2 + binary.size(),
+        file_size - size_size - binary.size());
+    }
+  }
+  munmap(data, file_size);
+  return result;
+}
+
+namespace {
 
-  v8::Local<v8::Value> args[] = { module->v8_object() };
-  auto result = store->v8_function(V8_F_IMPORTS)->Call(
-    context, v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return wasm_importtype_vec_empty();
-  auto array = v8::Local<v8::Array>::Cast(result.ToLocalChecked());
-  size_t size = array->Length();
+auto write_fd(void* env, const byte_t* data, size_t size) -> bool {
+  auto fd = *static_cast<int*>(env);
+  while (size > 0) {
+    auto n = write(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
 
-  wasm_importtype_vec_t imports = wasm_importtype_vec_new_uninitialized(size);
-  for (size_t i = 0; i < size; ++i) {
-    auto desc = v8::Local<v8::Object>::Cast(array->Get(i));
-    auto module_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_MODULE)).ToLocalChecked());
-    auto name_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_NAME)).ToLocalChecked());
-    auto kind_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_KIND)).ToLocalChecked());
+}  // namespace
 
-    auto type = wasm_externtype_new_from_v8_kind(store, kind_str);
-    auto module = wasm_byte_vec_new_from_v8_string(module_str);
-    auto name = wasm_byte_vec_new_from_v8_string(name_str);
-    imports.data[i] = wasm_importtype_new(module, name, type);
+void code_cache_write(
+  const std::string& path,
+  const byte_t* binary, size_t binary_size, const byte_t* code, size_t code_size
+) {
+  // Write to a unique temporary file first and rename it into place, so that
+  // concurrent readers never observe a partially written entry. The data is
+  // synced before the rename, so a crash cannot leave a truncated entry under
+  // the final name.
+  static std::atomic<uint32_t> counter{0};
+  char suffix[48];
+  snprintf(suffix, sizeof(suffix), ".tmp%ld-%" PRIu32,
+    static_cast<long>(getpid()), counter++);
+  auto temp = path + suffix;
+  int fd = open(temp.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) return;
+  byte_t prefix[10];
+  auto ptr = prefix;
+  wasm::bin::encode_u64(ptr, binary_size);
+  auto ok = write_fd(&fd, prefix, ptr - prefix) &&
+    write_fd(&fd, binary, binary_size) && write_fd(&fd, code, code_size) &&
+    fsync(fd) == 0;
+  if (close(fd) != 0 || !ok || rename(temp.c_str(), path.c_str()) != 0) {
+    unlink(temp.c_str());
   }
+}
+
+struct CodeCacheEntry {
+  EngineImpl* engine;
+  std::string path;
+};
 
-  return imports;
-*/
+void code_cache_written(
+  void* env, const uint8_t* binary, size_t binary_size,
+  const uint8_t* code, size_t code_size
+) {
+  auto entry = static_cast<CodeCacheEntry*>(env);
+  if (code) {
+    code_cache_write(entry->path, reinterpret_cast<const byte_t*>(binary),
+      binary_size, reinterpret_cast<const byte_t*>(code), code_size);
+  }
+  auto engine = entry->engine;
+  delete entry;
+  std::lock_guard<std::mutex> lock(engine->code_cache_mutex);
+  if (--engine->code_cache_pending == 0) engine->code_cache_done.notify_all();
+}
+
+// Entries are written once the module has been tiered up, since serializing
+// right after compilation would mostly capture Liftoff code or nothing at all
+// for lazily compiled functions. Both the tier-up and the write happen on a
+// worker thread, and the engine waits for pending writes when destroyed.
+void code_cache_store(EngineImpl* engine, uint64_t hash, v8::Local<v8::Object> obj) {
+  auto entry = new(std::nothrow) CodeCacheEntry{engine, code_cache_path(engine, hash)};
+  if (!entry) return;
+  {
+    std::lock_guard<std::mutex> lock(engine->code_cache_mutex);
+    ++engine->code_cache_pending;
+  }
+  wasm_v8::module_serialize_async(
+    engine->platform.get(), obj, &code_cache_written, entry);
 }
 
-auto Module::exports() const -> ownvec<ExportType> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  auto module = impl(this)->v8_object();
-  auto binary = vec<byte_t>::adopt(
-    wasm_v8::module_binary_size(module),
-    const_cast<byte_t*>(wasm_v8::module_binary(module))
-  );
-  auto exports = wasm::bin::exports(binary);
-  binary.release();
-  return exports;
-  // return impl(this)->data->exports.copy();
-/* OBSOLETE?
-  auto store = module->store();
+// Engine-wide compiled modules
+
+auto compiled_lookup(EngineImpl* engine, uint64_t hash, const vec<byte_t>& binary)
+-> std::shared_ptr<CompiledCode> {
+  // Declared outside the lock, since dropping the last reference to a
+  // mismatching entry locks the table again in ~CompiledCode.
+  std::shared_ptr<CompiledCode> code;
+  {
+    std::lock_guard<std::mutex> lock(engine->compiled_mutex);
+    auto it = engine->compiled.find(hash);
+    if (it == engine->compiled.end()) return nullptr;
+    code = it->second.lock();
+  }
+  if (!code) return nullptr;
+  auto bytes = code->compiled.GetWireBytesRef();
+  if (bytes.size() != binary.size() ||
+      std::memcmp(bytes.data(), binary.get(), binary.size()) != 0) {
+    return nullptr;
+  }
+  return code;
+}
+
+auto compiled_insert(
+  EngineImpl* engine, uint64_t hash, v8::Local<v8::Object> module
+) -> std::shared_ptr<CompiledCode> {
+  auto code = std::shared_ptr<CompiledCode>(new(std::nothrow) CompiledCode{
+    engine, hash, module.As<v8::WasmModuleObject>()->GetCompiledModule()});
+  if (!code) return nullptr;
+  std::lock_guard<std::mutex> lock(engine->compiled_mutex);
+  auto& entry = engine->compiled[hash];
+  // On a hash collision, the live entry stays.
+  if (entry.expired()) entry = code;
+  return code;
+}
+
+// Wraps a freshly compiled or loaded module, registering it engine-wide
+// and, if it was compiled for the code cache, there as well.
+auto module_register(
+  StoreImpl* store, v8::Local<v8::Object> obj, uint64_t hash, bool cache
+) -> own<Module> {
+  auto engine = store->engine();
+  auto code = compiled_insert(engine, hash, obj);
+  if (!code || !module_data(store, obj, std::move(code))) return nullptr;
+  auto module = RefImpl<Module>::make(store, obj);
+  if (module && cache && !engine->code_cache_dir.empty()) {
+    code_cache_store(engine, hash, obj);
+  }
+  return module;
+}
+
+// Finds a module without compiling it, by reusing the native module if any
+// store compiled the same bytes before, or else from the code cache.
+auto module_find(
+  StoreImpl* store, uint64_t hash, const vec<byte_t>& binary, bool cache
+) -> own<Module> {
+  auto engine = store->engine();
+  if (auto code = compiled_lookup(engine, hash, binary)) {
+    auto maybe_obj = v8::WasmModuleObject::FromCompiledModule(
+      store->isolate(), code->compiled);
+    if (maybe_obj.IsEmpty()) return nullptr;
+    v8::Local<v8::Object> obj = maybe_obj.ToLocalChecked();
+    if (!module_data(store, obj, std::move(code))) return nullptr;
+    return RefImpl<Module>::make(store, obj);
+  }
+  if (!cache || engine->code_cache_dir.empty()) return nullptr;
+  auto maybe_obj =
+    code_cache_load(store, code_cache_path(engine, hash), binary);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  return module_register(store, maybe_obj.ToLocalChecked(), hash, false);
+}
+
+// Internal modules, like the wrappers for host globals, pass cache = false,
+// so that they neither fill nor probe the code cache.
+auto module_make(StoreImpl* store, const vec<byte_t>& binary, bool cache)
+-> own<Module> {
   auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
+
+  auto hash = wasm::bin::hash(binary.get(), binary.size());
+  if (auto module = module_find(store, hash, binary, cache)) return module;
+
+  // The bytes are passed to V8 directly, which keeps its own copy as part
+  // of the compiled module.
+  auto maybe_obj = wasm_v8::module_compile(isolate,
+    reinterpret_cast<const uint8_t*>(binary.get()), binary.size());
+  if (maybe_obj.IsEmpty()) return nullptr;
+  return module_register(store, maybe_obj.ToLocalChecked(), hash, cache);
+}
 
-  v8::Local<v8::Value> args[] = { module->v8_object() };
-  auto result = store->v8_function(V8_F_EXPORTS)->Call(
-    context, v8::Undefined(isolate), 1, args);
-  if (result.IsEmpty()) return wasm_exporttype_vec_empty();
-  auto array = v8::Local<v8::Array>::Cast(result.ToLocalChecked());
-  size_t size = array->Length();
+auto Module::make(Store* store_abs, const vec<byte_t>& binary) -> own<Module> {
+  return module_make(impl(store_abs), binary, true);
+}
 
-  wasm_exporttype_vec_t exports = wasm_exporttype_vec_new_uninitialized(size);
-  for (size_t i = 0; i < size; ++i) {
-    auto desc = v8::Local<v8::Object>::Cast(array->Get(i));
-    auto name_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_NAME)).ToLocalChecked());
-    auto kind_str = v8::Local<v8::String>::Cast(
-      desc->Get(context, store->v8_string(V8_S_KIND)).ToLocalChecked());
+auto Module::imports() const -> ownvec<ImportType> {
+  StoreScope store_scope(impl(this)->isolate());
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  if (!data) return ownvec<ImportType>::invalid();
+  return data->imports.deep_copy();
+}
 
-    auto type = wasm_externtype_new_from_v8_kind(store, kind_str);
-    auto name = wasm_byte_vec_new_from_v8_string(name_str);
-    exports.data[i] = wasm_exporttype_new(name, type);
-  }
+auto Module::hash() const -> uint64_t {
+  StoreScope store_scope(impl(this)->isolate());
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  return data ? data->hash : 0;
+}
 
-  return exports;
-*/
+auto Module::exports() const -> ownvec<ExportType> {
+  StoreScope store_scope(impl(this)->isolate());
+  auto data = module_data(impl(this)->store(), impl(this)->v8_object());
+  if (!data) return ownvec<ExportType>::invalid();
+  return data->exports.deep_copy();
 }
 
 auto Module::serialize() const -> vec<byte_t> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto module = impl(this)->v8_object();
   auto binary_size = wasm_v8::module_binary_size(module);
   auto serial_size = wasm_v8::module_serialize_size(module);
@@ -1433,7 +2164,7 @@ auto Module::serialize() const -> vec<byte_t> {
 auto Module::deserialize(Store* store_abs, const vec<byte_t>& serialized) -> own<Module> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
   auto ptr = serialized.get();
   auto binary_size = wasm::bin::u64(ptr);
   auto size_size = ptr - serialized.get();
@@ -1442,46 +2173,399 @@ auto Module::deserialize(Store* store_abs, const vec<byte_t>& serialized) -> own
   auto maybe_obj = wasm_v8::module_deserialize(
     isolate, ptr2, binary_size, ptr2 + binary_size, serial_size);
   if (maybe_obj.IsEmpty()) return nullptr;
-  return RefImpl<Module>::make(store, maybe_obj.ToLocalChecked());
+  auto obj = maybe_obj.ToLocalChecked();
+  if (!module_data(store, obj)) return nullptr;
+  return RefImpl<Module>::make(store, obj);
 }
 
-
-// TODO(v8): do better when V8 can do better.
-
-template<class C>
-struct SharedImpl : Shared<C>, vec<byte_t> {
-  void destroy() {
-    stats.free(categorize<C>::value, this, Stats::SHARED);
-    delete this;
+auto Module::serialize_to(writer write, void* env) const -> bool {
+  StoreScope store_scope(impl(this)->isolate());
+  auto module = impl(this)->v8_object();
+  // The wire bytes are written straight from V8's copy, only the native
+  // code needs a buffer of its own.
+  auto serial_size = wasm_v8::module_serialize_size(module);
+  auto buffer = vec<byte_t>::make_uninitialized(serial_size);
+  if (!buffer || !wasm_v8::module_serialize(module, buffer.get(), serial_size)) {
+    return false;
   }
-};
-
-template<> struct implement<Shared<Module>> { using type = SharedImpl<Module>; };
-
-void Shared<Module>::destroy() {
-  impl(this)->destroy();
+  auto binary_size = wasm_v8::module_binary_size(module);
+  byte_t prefix[10];
+  auto ptr = prefix;
+  wasm::bin::encode_u64(ptr, binary_size);
+  return write(env, prefix, ptr - prefix) &&
+    write(env, wasm_v8::module_binary(module), binary_size) &&
+    write(env, buffer.get(), serial_size);
 }
 
-auto Module::share() const -> own<Shared<Module>> {
-  auto shared = static_cast<SharedImpl<Module>*>(new vec<byte_t>(serialize()));
-  stats.make(Stats::MODULE, shared, Stats::SHARED);
-  return own<Shared<Module>>(shared);
-}
+namespace {
 
-auto Module::obtain(Store* store, const Shared<Module>* shared) -> own<Module> {
-  return Module::deserialize(store, *impl(shared));
+auto read_fully(Module::reader read, void* env, byte_t* data, size_t size)
+-> bool {
+  while (size > 0) {
+    auto n = read(env, data, size);
+    if (n == 0 || n > size) return false;
+    data += n;
+    size -= n;
+  }
+  return true;
 }
 
+}  // namespace
 
+auto Module::serialize_to_fd(int fd) const -> bool {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    return serialize_to(&write_fd, &fd);
+  }
 
+  StoreScope store_scope(impl(this)->isolate());
+  auto module = impl(this)->v8_object();
+  auto binary_size = wasm_v8::module_binary_size(module);
+  auto serial_size = wasm_v8::module_serialize_size(module);
+  byte_t prefix[10];
+  auto ptr = prefix;
+  wasm::bin::encode_u64(ptr, binary_size);
+  if (!write_fd(&fd, prefix, ptr - prefix) ||
+      !write_fd(&fd, wasm_v8::module_binary(module), binary_size)) {
+    return false;
+  }
 
-// Externals
+  // Extend the file and let V8 serialize into a shared mapping of it. This
+  // requires the file to be open for reading, too, so fall back to a buffer.
+  auto pos = lseek(fd, 0, SEEK_CUR);
+  auto end = pos + static_cast<off_t>(serial_size);
+  if (pos < 0 || (st.st_size < end && ftruncate(fd, end) != 0)) return false;
+  auto base = pos & ~static_cast<off_t>(sysconf(_SC_PAGESIZE) - 1);
+  auto map_size = static_cast<size_t>(end - base);
+  auto data = serial_size == 0 ? MAP_FAILED :
+    mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, base);
+  if (data == MAP_FAILED) {
+    auto buffer = vec<byte_t>::make_uninitialized(serial_size);
+    return buffer &&
+      wasm_v8::module_serialize(module, buffer.get(), serial_size) &&
+      write_fd(&fd, buffer.get(), serial_size);
+  }
+  auto ok = wasm_v8::module_serialize(
+    module, static_cast<byte_t*>(data) + (pos - base), serial_size);
+  munmap(data, map_size);
+  return ok && lseek(fd, end, SEEK_SET) == end;
+}
+
+auto Module::deserialize_from(Store* store_abs, reader read, void* env)
+-> own<Module> {
+  // Read the size prefix byte by byte, so that no data is consumed beyond it.
+  byte_t prefix[10];
+  size_t size_size = 0;
+  do {
+    if (size_size == sizeof(prefix) ||
+        !read_fully(read, env, prefix + size_size, 1)) return nullptr;
+  } while (prefix[size_size++] & 0x80);
+  const byte_t* ptr = prefix;
+  auto binary_size = wasm::bin::u64(ptr);
 
-template<> struct implement<Extern> { using type = RefImpl<Extern>; };
+  auto binary = vec<byte_t>::make_uninitialized(binary_size);
+  if (!binary || !read_fully(read, env, binary.get(), binary_size)) {
+    return nullptr;
+  }
 
+  // The size of the native code is not known up front.
+  auto buffer = vec<byte_t>::make_uninitialized(64 * 1024);
+  size_t serial_size = 0;
+  while (true) {
+    if (serial_size == buffer.size()) {
+      auto grown = vec<byte_t>::make_uninitialized(2 * buffer.size());
+      if (!grown) return nullptr;
+      std::memcpy(grown.get(), buffer.get(), serial_size);
+      buffer = std::move(grown);
+    }
+    auto n = read(env, buffer.get() + serial_size, buffer.size() - serial_size);
+    if (n == 0) break;
+    if (n > buffer.size() - serial_size) return nullptr;
+    serial_size += n;
+  }
 
-void Extern::destroy() {
-  impl(this)->~RefImpl<Extern>();
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  StoreScope store_scope(isolate);
+  auto maybe_obj = wasm_v8::module_deserialize(isolate,
+    reinterpret_cast<const uint8_t*>(binary.get()), binary_size,
+    reinterpret_cast<const uint8_t*>(buffer.get()), serial_size);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  auto obj = maybe_obj.ToLocalChecked();
+  if (!module_data(store, obj)) return nullptr;
+  return RefImpl<Module>::make(store, obj);
+}
+
+
+// Asynchronous compilation
+
+struct AsyncCompile {
+  StoreImpl* store;
+  vec<byte_t> binary;  // kept alive until compilation completes
+  Module::compile_callback callback;
+  void* env;
+};
+
+void async_compile_callback(void* env, v8::Local<v8::Object> module) {
+  auto compile = std::unique_ptr<AsyncCompile>(static_cast<AsyncCompile*>(env));
+  auto store = compile->store;
+  own<Module> result;
+  if (!module.IsEmpty() && store->alive()) {
+    StoreScope store_scope(store->isolate());
+    if (module_data(store, module)) result = RefImpl<Module>::make(store, module);
+  }
+  store->count_completions(1);
+  compile->callback(compile->env, std::move(result));
+}
+
+void Module::make_async(
+  Store* store_abs, vec<byte_t>&& binary, compile_callback callback, void* env
+) {
+  auto store = impl(store_abs);
+  StoreScope store_scope(store->isolate());
+  auto compile =
+    new(std::nothrow) AsyncCompile{store, std::move(binary), callback, env};
+  if (!compile) {
+    callback(env, own<Module>());
+    return;
+  }
+  wasm_v8::module_compile_async(store->isolate(),
+    reinterpret_cast<const uint8_t*>(compile->binary.get()),
+    compile->binary.size(), &async_compile_callback, compile);
+}
+
+
+// Bulk compilation
+
+namespace {
+
+auto elapsed_ns(std::chrono::steady_clock::time_point start) -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+struct BulkCompile {
+  using waiter =
+    std::pair<Module::BulkItem*, std::chrono::steady_clock::time_point>;
+
+  StoreImpl* store;
+  Module::BulkItem* item;
+  uint64_t hash;
+  std::chrono::steady_clock::time_point start;
+  size_t* in_flight;
+  // Compilations in flight by hash, and later items with the same binary,
+  // which take the result instead of being compiled again.
+  std::unordered_map<uint64_t, BulkCompile*>* pending;
+  std::vector<waiter> waiters;
+};
+
+void bulk_compile_callback(void* env, v8::Local<v8::Object> module) {
+  auto compile = std::unique_ptr<BulkCompile>(static_cast<BulkCompile*>(env));
+  auto store = compile->store;
+  StoreScope store_scope(store->isolate());
+  if (!module.IsEmpty()) {
+    compile->item->module =
+      module_register(store, module, compile->hash, true);
+  }
+  compile->item->time_ns = elapsed_ns(compile->start);
+  for (auto& waiter : compile->waiters) {
+    auto& result = compile->item->module;
+    waiter.first->module = result ? result->copy() : own<Module>();
+    waiter.first->time_ns = elapsed_ns(waiter.second);
+  }
+  auto it = compile->pending->find(compile->hash);
+  if (it != compile->pending->end() && it->second == compile.get()) {
+    compile->pending->erase(it);
+  }
+  --*compile->in_flight;
+}
+
+}  // namespace
+
+auto Module::make_many(
+  Store* store_abs, size_t n, BulkItem items[], size_t max_parallel
+) -> uint64_t {
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  auto start = std::chrono::steady_clock::now();
+  if (max_parallel == 0) {
+    max_parallel = std::max(store->platform()->NumberOfWorkerThreads(), 1);
+  }
+
+  auto next = [&](size_t i, bool serialized) {
+    while (i < n && items[i].serialized != serialized) ++i;
+    return i;
+  };
+  auto next_compile = next(0, false);
+  auto next_deserialize = next(0, true);
+  size_t in_flight = 0;
+  std::unordered_map<uint64_t, BulkCompile*> pending;
+  while (true) {
+    // Keep the worker threads busy before doing any work on this thread.
+    if (next_compile < n && in_flight < max_parallel) {
+      auto item = &items[next_compile];
+      next_compile = next(next_compile + 1, false);
+      auto item_start = std::chrono::steady_clock::now();
+      StoreScope store_scope(isolate);
+      auto& binary = *item->bytes;
+      auto hash = wasm::bin::hash(binary.get(), binary.size());
+      auto it = pending.find(hash);
+      if (it != pending.end()) {
+        auto& other = *it->second->item->bytes;
+        if (other.size() == binary.size() &&
+            std::memcmp(other.get(), binary.get(), binary.size()) == 0) {
+          it->second->waiters.emplace_back(item, item_start);
+          continue;
+        }
+      }
+      item->module = module_find(store, hash, binary, true);
+      auto compile = item->module ? nullptr : new(std::nothrow) BulkCompile{
+        store, item, hash, item_start, &in_flight, &pending, {}};
+      if (!compile) {
+        // Found, or failed for lack of memory.
+        item->time_ns = elapsed_ns(item_start);
+      } else {
+        ++in_flight;
+        // On a hash collision, the earlier compilation keeps the entry.
+        pending.emplace(hash, compile);
+        wasm_v8::module_compile_async(isolate,
+          reinterpret_cast<const uint8_t*>(binary.get()), binary.size(),
+          &bulk_compile_callback, compile);
+      }
+    } else if (next_deserialize < n) {
+      // Sequential, since V8 only deserializes on the isolate's thread.
+      auto item = &items[next_deserialize];
+      next_deserialize = next(next_deserialize + 1, true);
+      auto item_start = std::chrono::steady_clock::now();
+      item->module = Module::deserialize(store, *item->bytes);
+      item->time_ns = elapsed_ns(item_start);
+      store->run_pending(false);
+    } else if (in_flight > 0) {
+      store->run_pending(true);
+    } else {
+      break;
+    }
+  }
+  return elapsed_ns(start);
+}
+
+
+// Streaming compilation
+
+struct ModuleStreamerImpl : ModuleStreamer {
+  StoreImpl* store;
+  wasm_v8::module_streamer_t* streamer;
+
+  ModuleStreamerImpl(StoreImpl* store, wasm_v8::module_streamer_t* streamer)
+    : store(store), streamer(streamer) {
+    store->retain_handle();
+    stats.make(Stats::MODULESTREAMER, this);
+  }
+
+  ~ModuleStreamerImpl() {
+    wasm_v8::module_streamer_delete(streamer);
+    store->release_handle();
+    stats.free(Stats::MODULESTREAMER, this);
+  }
+};
+
+template<> struct implement<ModuleStreamer> { using type = ModuleStreamerImpl; };
+
+
+void ModuleStreamer::destroy() {
+  delete impl(this);
+}
+
+auto ModuleStreamer::make(Store* store_abs) -> own<ModuleStreamer> {
+  auto store = impl(store_abs);
+  StoreScope store_scope(store->isolate());
+  auto streamer = wasm_v8::module_streamer_new(store->isolate());
+  if (!streamer) return nullptr;
+  auto module_streamer = new(std::nothrow) ModuleStreamerImpl(store, streamer);
+  if (!module_streamer) wasm_v8::module_streamer_delete(streamer);
+  return own<ModuleStreamer>(module_streamer);
+}
+
+void ModuleStreamer::feed(const byte_t* data, size_t size) {
+  auto streamer = impl(this);
+  StoreScope store_scope(streamer->store->isolate());
+  wasm_v8::module_streamer_feed(
+    streamer->streamer, reinterpret_cast<const uint8_t*>(data), size);
+}
+
+auto ModuleStreamer::finish() -> own<Module> {
+  auto streamer = impl(this);
+  auto store = streamer->store;
+  auto isolate = store->isolate();
+  StoreScope store_scope(isolate);
+  wasm_v8::module_streamer_finish(streamer->streamer);
+  while (!wasm_v8::module_streamer_done(streamer->streamer)) {
+    v8::platform::PumpMessageLoop(store->platform(), isolate,
+      v8::platform::MessageLoopBehavior::kWaitForWork);
+  }
+  auto maybe_obj = wasm_v8::module_streamer_result(streamer->streamer);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  auto obj = maybe_obj.ToLocalChecked();
+  if (!module_data(store, obj)) return nullptr;
+  return RefImpl<Module>::make(store, obj);
+}
+
+
+// Shared modules hold on to V8's native module, which is engine-wide and
+// reference-counted, so that other stores import it without recompiling.
+
+template<class C> struct SharedImpl;
+
+template<>
+struct SharedImpl<Module> : Shared<Module> {
+  v8::CompiledWasmModule compiled;
+
+  explicit SharedImpl(v8::CompiledWasmModule&& compiled) :
+    compiled(std::move(compiled)) {}
+
+  void destroy() {
+    stats.free(Stats::MODULE, this, Stats::SHARED);
+    delete this;
+  }
+};
+
+template<> struct implement<Shared<Module>> { using type = SharedImpl<Module>; };
+
+void Shared<Module>::destroy() {
+  impl(this)->destroy();
+}
+
+auto Module::share() const -> own<Shared<Module>> {
+  StoreScope store_scope(impl(this)->isolate());
+  auto module = impl(this)->v8_object().As<v8::WasmModuleObject>();
+  auto shared = new(std::nothrow) SharedImpl<Module>(module->GetCompiledModule());
+  if (!shared) return own<Shared<Module>>();
+  stats.make(Stats::MODULE, shared, Stats::SHARED);
+  return own<Shared<Module>>(shared);
+}
+
+auto Module::obtain(Store* store_abs, const Shared<Module>* shared) -> own<Module> {
+  auto store = impl(store_abs);
+  auto isolate = store->isolate();
+  StoreScope store_scope(isolate);
+  auto maybe_obj =
+    v8::WasmModuleObject::FromCompiledModule(isolate, impl(shared)->compiled);
+  if (maybe_obj.IsEmpty()) return nullptr;
+  v8::Local<v8::Object> obj = maybe_obj.ToLocalChecked();
+  if (!module_data(store, obj)) return nullptr;
+  return RefImpl<Module>::make(store, obj);
+}
+
+
+
+
+// Externals
+
+template<> struct implement<Extern> { using type = RefImpl<Extern>; };
+
+
+void Extern::destroy() {
+  impl(this)->~RefImpl<Extern>();
 }
 
 auto Extern::copy() const -> own<Extern> {
@@ -1489,7 +2573,7 @@ auto Extern::copy() const -> own<Extern> {
 }
 
 auto Extern::kind() const -> ExternKind {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return static_cast<ExternKind>(wasm_v8::extern_kind(impl(this)->v8_object()));
 }
 
@@ -1555,10 +2639,12 @@ auto Func::copy() const -> own<Func> {
 struct FuncData {
   Store* store;
   own<FuncType> type;
-  enum Kind { CALLBACK, CALLBACK_WITH_ENV } kind;
+  FuncSig sig;
+  enum Kind { CALLBACK, CALLBACK_WITH_ENV, CALLBACK_RAW } kind;
   union {
     Func::callback callback;
     Func::callback_with_env callback_with_env;
+    Func::callback_raw callback_raw;
   };
   void (*finalizer)(void*);
   void* env;
@@ -1571,6 +2657,29 @@ struct FuncData {
     stats.make(Stats::FUNCDATA_VALTYPE, nullptr, Stats::OWN, type->results().size());
     if (type->params().get()) stats.make(Stats::FUNCDATA_VALTYPE, nullptr, Stats::VEC);
     if (type->results().get()) stats.make(Stats::FUNCDATA_VALTYPE, nullptr, Stats::VEC);
+
+    sig.param_arity = type->params().size();
+    sig.result_arity = type->results().size();
+    sig.kinds.reset(
+      new(std::nothrow) ValKind[sig.param_arity + sig.result_arity]);
+    if (!sig.kinds) return;
+    for (size_t i = 0; i < sig.param_arity; ++i) {
+      sig.kinds[i] = type->params()[i]->kind();
+    }
+    for (size_t i = 0; i < sig.result_arity; ++i) {
+      sig.kinds[sig.param_arity + i] = type->results()[i]->kind();
+    }
+    sig.init();
+  }
+
+  // Returns null if allocation fails.
+  static auto make(Store* store, const FuncType* type, Kind kind) -> FuncData* {
+    auto data = new(std::nothrow) FuncData(store, type, kind);
+    if (data && !data->sig.kinds) {
+      delete data;
+      return nullptr;
+    }
+    return data;
   }
 
   ~FuncData() {
@@ -1582,81 +2691,401 @@ struct FuncData {
     if (finalizer) (*finalizer)(env);
   }
 
-  static void v8_callback(const v8::FunctionCallbackInfo<v8::Value>&);
+  auto invoke(const Val args[], Val results[]) -> own<Trap>;
+
+  static void v8_callback(void* env, char* argv);
   static void finalize_func_data(void* data);
 };
 
 namespace {
 
-auto make_func(Store* store_abs, FuncData* data) -> own<Func> {
+// Scratch storage for host call arguments and results. Signatures of
+// typical width are served from the stack.
+template<class T, size_t N = 16>
+class ScratchArray {
+  T inline_[N];
+  std::unique_ptr<T[]> heap_;
+  size_t size_;
+
+public:
+  explicit ScratchArray(size_t size) : size_(size) {
+    if (size > N) heap_.reset(new(std::nothrow) T[size]);
+  }
+
+  // False if the storage could not be allocated.
+  explicit operator bool() const { return size_ <= N || heap_ != nullptr; }
+
+  auto get() -> T* {
+    return size_ == 0 ? nullptr : size_ > N ? heap_.get() : inline_;
+  }
+
+  auto operator[](size_t i) -> T& {
+    assert(i < size_);
+    return get()[i];
+  }
+};
+
+auto val_to_raw(const Val& v) -> uint64_t {
+  switch (v.kind()) {
+    case ValKind::I32: return raw_encode(v.i32());
+    case ValKind::I64: return raw_encode(v.i64());
+    case ValKind::F32: return raw_encode(v.f32());
+    case ValKind::F64: return raw_encode(v.f64());
+    default: assert(false);
+  }
+}
+
+auto raw_to_val(uint64_t raw, ValKind kind) -> Val {
+  switch (kind) {
+    case ValKind::I32: return Val(raw_decode<int32_t>(raw));
+    case ValKind::I64: return Val(raw_decode<int64_t>(raw));
+    case ValKind::F32: return Val(raw_decode<float32_t>(raw));
+    case ValKind::F64: return Val(raw_decode<float64_t>(raw));
+    default: assert(false);
+  }
+}
+
+// Host function arguments and results are packed without padding.
+
+auto slot_to_val(StoreImpl* store, const char* slot, ValKind kind) -> Val {
+  if (is_ref(kind)) {
+    auto isolate = store->isolate();
+    return Val(v8_to_ref(store, wasm_v8::func_slot_get_ref(isolate, slot)));
+  }
+  uint64_t raw = 0;
+  std::memcpy(&raw, slot, wasm_v8::func_slot_size(
+    static_cast<wasm_v8::val_kind_t>(kind)));
+  return raw_to_val(raw, kind);
+}
+
+void val_to_slot(StoreImpl* store, char* slot, ValKind kind, const Val& v) {
+  if (is_ref(kind)) {
+    wasm_v8::func_slot_set_ref(store->isolate(), slot,
+      static_cast<wasm_v8::val_kind_t>(kind), ref_to_v8(store, v.ref()));
+    return;
+  }
+  auto raw = val_to_raw(v);
+  std::memcpy(slot, &raw, wasm_v8::func_slot_size(
+    static_cast<wasm_v8::val_kind_t>(kind)));
+}
+
+auto make_func_many(
+  Store* store_abs, size_t n, FuncData* const datas[]
+) -> ownvec<Func> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
-  auto context = store->context();
+  StoreScope store_scope(isolate);
 
-  // Create V8 function
-  auto v8_data = wasm_v8::foreign_new(isolate, data);
-  auto function_template = v8::FunctionTemplate::New(
-    isolate, &FuncData::v8_callback, v8_data);
-  auto maybe_func_obj = function_template->GetFunction(context);
-  if (maybe_func_obj.IsEmpty()) return own<Func>();
-  auto func_obj = maybe_func_obj.ToLocalChecked();
-
-  // Create wrapper instance
-  auto binary = wasm::bin::wrapper(data->type.get());
-  auto module = Module::make(store_abs, binary);
-
-  auto imports_obj = v8::Object::New(isolate);
-  auto module_obj = v8::Object::New(isolate);
-  auto str = store->v8_string(V8_S_EMPTY);
-  ignore(imports_obj->DefineOwnProperty(context, str, module_obj));
-  ignore(module_obj->DefineOwnProperty(context, str, func_obj));
-
-  v8::Local<v8::Value> instantiate_args[] = {
-    impl(module.get())->v8_object(), imports_obj
+  size_t total_arity = 0;
+  for (size_t i = 0; i < n; ++i) {
+    total_arity += datas[i]->sig.param_arity + datas[i]->sig.result_arity;
+  }
+  auto kinds = std::unique_ptr<wasm_v8::val_kind_t[]>(
+    new(std::nothrow) wasm_v8::val_kind_t[total_arity]);
+  auto defs = std::unique_ptr<wasm_v8::func_def_t[]>(
+    new(std::nothrow) wasm_v8::func_def_t[n]);
+  auto v8_functions = std::unique_ptr<v8::Local<v8::Function>[]>(
+    new(std::nothrow) v8::Local<v8::Function>[n]);
+  auto funcs = ownvec<Func>::make_uninitialized(n);
+  // Reserve the handles for the results, since the V8 functions own the
+  // function data once created and the batch cannot fail after that.
+  auto handles = std::unique_ptr<v8::Persistent<v8::Object>*[]>(
+    new(std::nothrow) v8::Persistent<v8::Object>*[n]);
+  size_t reserved = 0;
+  auto fail = [&]() {
+    while (reserved > 0) store->free_handle(handles[--reserved]);
+    // The caller keeps its environments; only the function data is freed.
+    for (size_t i = 0; i < n; ++i) {
+      datas[i]->finalizer = nullptr;
+      delete datas[i];
+    }
+    return ownvec<Func>::invalid();
   };
-  auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
-    context, 2, instantiate_args).ToLocalChecked();
-  assert(!instance_obj.IsEmpty());
-  assert(instance_obj->IsObject());
-  auto exports_obj = wasm_v8::instance_exports(instance_obj);
-  assert(!exports_obj.IsEmpty());
-  assert(exports_obj->IsObject());
-  auto wrapped_func_obj = v8::Local<v8::Function>::Cast(
-    exports_obj->Get(context, str).ToLocalChecked());
-  assert(!wrapped_func_obj.IsEmpty());
-  assert(wrapped_func_obj->IsFunction());
+  if (!kinds || !defs || !v8_functions || !funcs || !handles) return fail();
+  for (; reserved < n; ++reserved) {
+    handles[reserved] = store->make_handle();
+    if (!handles[reserved]) return fail();
+  }
+  auto ptr = kinds.get();
+  for (size_t i = 0; i < n; ++i) {
+    auto& sig = datas[i]->sig;
+    auto arity = sig.param_arity + sig.result_arity;
+    for (size_t j = 0; j < arity; ++j) {
+      ptr[j] = static_cast<wasm_v8::val_kind_t>(sig.kinds[j]);
+    }
+    defs[i] = {ptr, sig.param_arity, sig.result_arity,
+      &FuncData::v8_callback, datas[i], &FuncData::finalize_func_data};
+    ptr += arity;
+  }
 
-  auto func = RefImpl<Func>::make(store, wrapped_func_obj);
-  func->set_host_info(data, &FuncData::finalize_func_data);
-  return func;
+  // The function data is owned by the V8 functions from here on.
+  if (!wasm_v8::func_new_many(isolate, n, defs.get(), v8_functions.get())) {
+    return fail();
+  }
+  for (size_t i = 0; i < n; ++i) {
+    funcs[i] = RefImpl<Func>::make(store, handles[i], v8_functions[i]);
+  }
+  return funcs;
 }
 
-auto func_type(v8::Local<v8::Object> v8_func) -> own<FuncType> {
-  // return impl(this)->data->type->copy();
-  auto param_arity = wasm_v8::func_type_param_arity(v8_func);
-  auto result_arity = wasm_v8::func_type_result_arity(v8_func);
-  auto params = ownvec<ValType>::make_uninitialized(param_arity);
-  auto results = ownvec<ValType>::make_uninitialized(result_arity);
+auto make_func(Store* store, FuncData* data) -> own<Func> {
+  auto funcs = make_func_many(store, 1, &data);
+  return funcs ? std::move(funcs[0]) : own<Func>();
+}
+
+auto func_sig(const RefImpl<Func>* func) -> const FuncSig* {
+  auto v8_function = func->v8_object();
+  if (wasm_v8::func_is_host(v8_function)) {
+    return &static_cast<FuncData*>(wasm_v8::func_host_env(v8_function))->sig;
+  }
+  return func->store()->func_sig(v8_function);
+}
+
+// Reported by calls when an allocation fails.
+auto out_of_memory_trap(Store* store) -> own<Trap> {
+  return Trap::make(store, Message::make_nt(std::string("out of memory")));
+}
+
+auto func_type(const FuncSig* sig) -> own<FuncType> {
+  auto params = ownvec<ValType>::make_uninitialized(sig->param_arity);
+  auto results = ownvec<ValType>::make_uninitialized(sig->result_arity);
 
   for (size_t i = 0; i < params.size(); ++i) {
-    auto kind = static_cast<ValKind>(wasm_v8::func_type_param(v8_func, i));
-    params[i] = ValType::make(kind);
+    params[i] = ValType::make(sig->param(i));
   }
   for (size_t i = 0; i < results.size(); ++i) {
-    auto kind = static_cast<ValKind>(wasm_v8::func_type_result(v8_func, i));
-    results[i] = ValType::make(kind);
+    results[i] = ValType::make(sig->result(i));
   }
 
   return FuncType::make(std::move(params), std::move(results));
 }
 
+auto exception_to_trap(
+  StoreImpl* store, v8::Local<v8::Value> exception
+) -> own<Trap> {
+  if (!exception->IsObject()) {
+    auto maybe_string = exception->ToString(store->context());
+    auto string = maybe_string.IsEmpty()
+      ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
+    exception = v8::Exception::Error(string);
+  }
+  return RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
+}
+
+// Calls a Wasm function through JS, storing the JS result in *result.
+auto v8_call(
+  StoreImpl* store, v8::Local<v8::Function> v8_function,
+  size_t argc, v8::Local<v8::Value> v8_args[], v8::Local<v8::Value>* result
+) -> own<Trap> {
+  auto isolate = store->isolate();
+  v8::TryCatch handler(isolate);
+  auto maybe_val = v8_function->Call(
+    store->context(), v8::Undefined(isolate), argc, v8_args);
+  if (handler.HasCaught()) return exception_to_trap(store, handler.Exception());
+  *result = maybe_val.ToLocalChecked();
+  return nullptr;
+}
+
+// Buffer for direct calls, holding arguments and then results.
+class PackedArgs {
+  ScratchArray<uint64_t> buffer_;
+
+public:
+  explicit PackedArgs(const FuncSig* sig) :
+    buffer_(std::max<size_t>(1, (sig->packed_size + 7) / 8)) {}
+
+  explicit operator bool() const { return bool(buffer_); }
+  auto get() -> char* { return reinterpret_cast<char*>(buffer_.get()); }
+};
+
+auto v8_call_packed(
+  StoreImpl* store, v8::Local<v8::Function> v8_function, char* argv
+) -> own<Trap> {
+  v8::Local<v8::Value> exception;
+  if (wasm_v8::func_call_entry(v8_function, argv, &exception)) return nullptr;
+  return exception_to_trap(store, exception);
+}
+
+// Multiple results come back from JS as an array.
+auto v8_result(
+  StoreImpl* store, v8::Local<v8::Value> val, size_t arity, size_t i
+) -> v8::Local<v8::Value> {
+  if (arity == 1) {
+    assert(!val->IsUndefined());
+    return val;
+  }
+  assert(val->IsArray());
+  auto array = v8::Local<v8::Array>::Cast(val);
+  auto maybe = array->Get(store->context(), i);
+  assert(!maybe.IsEmpty());
+  return maybe.ToLocalChecked();
+}
+
+// Per-function call setup, reusable across calls within a handle scope.
+// Numeric Wasm functions are entered directly, host functions are called
+// without entering V8 at all, anything else goes through JS.
+class FuncCaller {
+  StoreImpl* store_;
+  const FuncSig* sig_;
+  v8::Local<v8::Function> v8_function_;
+  wasm_v8::func_target_t target_;
+  FuncData* data_ = nullptr;
+
+public:
+  FuncCaller(const RefImpl<Func>* func, const FuncSig* sig) :
+    store_(func->store()), sig_(sig),
+    v8_function_(v8::Local<v8::Function>::Cast(func->v8_object()))
+  {
+    v8::Local<v8::Object> host = v8_function_;
+    if (wasm_v8::func_is_host(v8_function_)) {
+      target_ = wasm_v8::TARGET_HOST;
+    } else if (!sig->numeric) {
+      target_ = wasm_v8::TARGET_JS;
+    } else {
+      target_ = wasm_v8::func_call_target(v8_function_, &host);
+    }
+    if (target_ == wasm_v8::TARGET_HOST) {
+      data_ = static_cast<FuncData*>(wasm_v8::func_host_env(host));
+    }
+  }
+
+  // Reuses a target resolved by an earlier caller for the same function.
+  FuncCaller(const RefImpl<Func>* func, const Func::RawTarget& target) :
+    store_(func->store()), sig_(static_cast<const FuncSig*>(target.sig)),
+    v8_function_(v8::Local<v8::Function>::Cast(func->v8_object())),
+    target_(static_cast<wasm_v8::func_target_t>(target.kind)),
+    data_(static_cast<FuncData*>(target.data)) {}
+
+  auto raw_target() const -> Func::RawTarget {
+    Func::RawTarget target;
+    target.sig = sig_;
+    target.data = data_;
+    target.kind = target_;
+    return target;
+  }
+
+  auto call(const Val args[], Val results[]) -> own<Trap>;
+  auto call_raw(uint64_t slots[]) -> own<Trap>;
+};
+
+auto FuncCaller::call(const Val args[], Val results[]) -> own<Trap> {
+  auto store = store_;
+  auto sig = sig_;
+  switch (target_) {
+    case wasm_v8::TARGET_HOST: return data_->invoke(args, results);
+    case wasm_v8::TARGET_WASM: {
+      PackedArgs packed(sig);
+      if (!packed) return out_of_memory_trap(store);
+      auto p = packed.get();
+      for (size_t i = 0; i < sig->param_arity; ++i) {
+        val_to_slot(store, p, sig->param(i), args[i]);
+        p += wasm_v8::func_slot_size(
+          static_cast<wasm_v8::val_kind_t>(sig->param(i)));
+      }
+      auto trap = v8_call_packed(store, v8_function_, packed.get());
+      if (trap) return trap;
+      p = packed.get();
+      for (size_t i = 0; i < sig->result_arity; ++i) {
+        new (&results[i]) Val(slot_to_val(store, p, sig->result(i)));
+        p += wasm_v8::func_slot_size(
+          static_cast<wasm_v8::val_kind_t>(sig->result(i)));
+      }
+      return nullptr;
+    }
+    case wasm_v8::TARGET_JS: break;
+  }
+
+  StoreScope store_scope(store->isolate());
+  ScratchArray<v8::Local<v8::Value>> v8_args(sig->param_arity);
+  if (!v8_args) return out_of_memory_trap(store);
+  for (size_t i = 0; i < sig->param_arity; ++i) {
+    v8_args[i] = val_to_v8(store, args[i]);
+  }
+
+  v8::Local<v8::Value> val;
+  auto trap = v8_call(store, v8_function_, sig->param_arity, v8_args.get(), &val);
+  if (trap) return trap;
+
+  if (sig->result_arity == 0) assert(val->IsUndefined());
+  for (size_t i = 0; i < sig->result_arity; ++i) {
+    new (&results[i]) Val(v8_to_val(
+      store, v8_result(store, val, sig->result_arity, i), sig->result(i)));
+  }
+  return nullptr;
+}
+
+auto FuncCaller::call_raw(uint64_t slots[]) -> own<Trap> {
+  auto store = store_;
+  auto sig = sig_;
+  switch (target_) {
+    case wasm_v8::TARGET_HOST: {
+      if (data_->kind == FuncData::CALLBACK_RAW) {
+        return data_->callback_raw(data_->env, slots);
+      }
+      ScratchArray<Val> args(sig->param_arity);
+      ScratchArray<Val> results(sig->result_arity);
+      if (!args || !results) return out_of_memory_trap(store);
+      for (size_t i = 0; i < sig->param_arity; ++i) {
+        args[i] = raw_to_val(slots[i], sig->param(i));
+      }
+      auto trap = data_->invoke(args.get(), results.get());
+      if (trap) return trap;
+      for (size_t i = 0; i < sig->result_arity; ++i) {
+        slots[i] = val_to_raw(results[i]);
+      }
+      return nullptr;
+    }
+    case wasm_v8::TARGET_WASM: {
+      // Narrow the slots into the packed layout, and widen results back.
+      PackedArgs packed(sig);
+      if (!packed) return out_of_memory_trap(store);
+      auto p = packed.get();
+      for (size_t i = 0; i < sig->param_arity; ++i) {
+        auto size = wasm_v8::func_slot_size(
+          static_cast<wasm_v8::val_kind_t>(sig->param(i)));
+        std::memcpy(p, &slots[i], size);
+        p += size;
+      }
+      auto trap = v8_call_packed(store, v8_function_, packed.get());
+      if (trap) return trap;
+      p = packed.get();
+      for (size_t i = 0; i < sig->result_arity; ++i) {
+        auto size = wasm_v8::func_slot_size(
+          static_cast<wasm_v8::val_kind_t>(sig->result(i)));
+        slots[i] = 0;
+        std::memcpy(&slots[i], p, size);
+        p += size;
+      }
+      return nullptr;
+    }
+    case wasm_v8::TARGET_JS: break;
+  }
+
+  StoreScope store_scope(store->isolate());
+  ScratchArray<v8::Local<v8::Value>> v8_args(sig->param_arity);
+  if (!v8_args) return out_of_memory_trap(store);
+  for (size_t i = 0; i < sig->param_arity; ++i) {
+    v8_args[i] = raw_to_v8(store, slots[i], sig->param(i));
+  }
+
+  v8::Local<v8::Value> val;
+  auto trap = v8_call(store, v8_function_, sig->param_arity, v8_args.get(), &val);
+  if (trap) return trap;
+
+  for (size_t i = 0; i < sig->result_arity; ++i) {
+    slots[i] = v8_to_raw(
+      store, v8_result(store, val, sig->result_arity, i), sig->result(i));
+  }
+  return nullptr;
+}
+
 }  // namespace
 
 auto Func::make(
   Store* store, const FuncType* type, Func::callback callback
 ) -> own<Func> {
-  auto data = new FuncData(store, type, FuncData::CALLBACK);
+  auto data = FuncData::make(store, type, FuncData::CALLBACK);
+  if (!data) return own<Func>();
   data->callback = callback;
   return make_func(store, data);
 }
@@ -1665,129 +3094,460 @@ auto Func::make(
   Store* store, const FuncType* type,
   callback_with_env callback, void* env, void (*finalizer)(void*)
 ) -> own<Func> {
-  auto data = new FuncData(store, type, FuncData::CALLBACK_WITH_ENV);
+  auto data = FuncData::make(store, type, FuncData::CALLBACK_WITH_ENV);
+  if (!data) return own<Func>();
   data->callback_with_env = callback;
   data->env = env;
   data->finalizer = finalizer;
   return make_func(store, data);
 }
 
+auto Func::make_raw(
+  Store* store, const FuncType* type,
+  callback_raw callback, void* env, void (*finalizer)(void*)
+) -> own<Func> {
+  auto& params = type->params();
+  auto& results = type->results();
+  for (size_t i = 0; i < params.size(); ++i) {
+    if (params[i]->is_ref()) return nullptr;
+  }
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (results[i]->is_ref()) return nullptr;
+  }
+  auto data = FuncData::make(store, type, FuncData::CALLBACK_RAW);
+  if (!data) return own<Func>();
+  data->callback_raw = callback;
+  data->env = env;
+  data->finalizer = finalizer;
+  return make_func(store, data);
+}
+
+auto Func::make_many(
+  Store* store, size_t n, const Def defs[]
+) -> ownvec<Func> {
+  auto datas = std::unique_ptr<FuncData*[]>(new(std::nothrow) FuncData*[n]);
+  if (!datas) return ownvec<Func>::invalid();
+  for (size_t i = 0; i < n; ++i) {
+    auto data = FuncData::make(store, defs[i].type, FuncData::CALLBACK_WITH_ENV);
+    if (!data) {
+      while (i > 0) {
+        datas[--i]->finalizer = nullptr;
+        delete datas[i];
+      }
+      return ownvec<Func>::invalid();
+    }
+    data->callback_with_env = defs[i].callback;
+    data->env = defs[i].env;
+    data->finalizer = defs[i].finalizer;
+    datas[i] = data;
+  }
+  return make_func_many(store, n, datas.get());
+}
+
 auto Func::type() const -> own<FuncType> {
-  // return impl(this)->data->type->copy();
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  return func_type(impl(this)->v8_object());
+  StoreScope store_scope(impl(this)->isolate());
+  auto sig = func_sig(impl(this));
+  return sig ? func_type(sig) : own<FuncType>();
 }
 
 auto Func::param_arity() const -> size_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  return wasm_v8::func_type_param_arity(impl(this)->v8_object());
+  StoreScope store_scope(impl(this)->isolate());
+  auto sig = func_sig(impl(this));
+  return sig ? sig->param_arity : 0;
 }
 
 auto Func::result_arity() const -> size_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
-  return wasm_v8::func_type_result_arity(impl(this)->v8_object());
+  StoreScope store_scope(impl(this)->isolate());
+  auto sig = func_sig(impl(this));
+  return sig ? sig->result_arity : 0;
 }
 
 auto Func::call(const vec<Val>& args, vec<Val>& results) const -> own<Trap> {
   auto func = impl(this);
-  auto store = func->store();
-  auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(func->isolate());
+  auto sig = func_sig(func);
+  if (!sig) return out_of_memory_trap(func->store());
+  for (size_t i = 0; i < sig->param_arity; ++i) {
+    assert(args[i].kind() == sig->param(i));
+  }
+  return FuncCaller(func, sig).call(args.get(), results.get());
+}
 
-  auto context = store->context();
-  auto type = this->type();
-  auto& param_types = type->params();
-  auto& result_types = type->results();
-
-  // TODO: cache v8_args array per thread.
-  auto v8_args = std::unique_ptr<v8::Local<v8::Value>[]>(
-    new(std::nothrow) v8::Local<v8::Value>[param_types.size()]);
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    assert(args[i].kind() == param_types[i]->kind());
-    v8_args[i] = val_to_v8(store, args[i]);
+void AsyncCall::run() {
+  Func::CallResult result{vec<Val>::invalid(), Message::invalid()};
+  if (trap) {
+    result.trap = std::move(trap);
+    callback(env, result);
+    return;
+  }
+  auto func_impl = impl(func.get());
+  StoreScope store_scope(func_impl->isolate());
+  auto sig = func_sig(func_impl);
+  if (!sig) {
+    result.trap = Message::make_nt(std::string("out of memory"));
+    callback(env, result);
+    return;
   }
+  bool valid = args.size() == sig->param_arity;
+  for (size_t i = 0; valid && i < sig->param_arity; ++i) {
+    valid = args[i].kind() == sig->param(i);
+  }
+  for (size_t i = 0; valid && i < sig->result_arity; ++i) {
+    valid = is_num(sig->result(i));
+  }
+  if (!valid) {
+    result.trap = Message::make_nt(
+      std::string("arguments or results not supported by call_async"));
+  } else {
+    result.results = vec<Val>::make_uninitialized(sig->result_arity);
+    auto call_trap =
+      FuncCaller(func_impl, sig).call(args.get(), result.results.get());
+    if (call_trap) result.trap = call_trap->message();
+  }
+  callback(env, result);
+}
+
+void AsyncCall::cancel() {
+  Func::CallResult result{vec<Val>::invalid(),
+    Message::make_nt(std::string("store deleted before call ran"))};
+  callback(env, result);
+}
+
+// Rejections are detected when a call is queued, but are still delivered
+// from Store::run_pending like any other completion.
+void queue_async_call(
+  own<Func>&& func, Store* store, vec<Val>&& args,
+  Func::async_callback callback, void* env, Message&& trap
+) {
+  if (!func && !trap) trap = Message::make_nt(std::string("out of memory"));
+  for (size_t i = 0; !trap && i < args.size(); ++i) {
+    if (args[i].is_ref()) {
+      trap = Message::make_nt(
+        std::string("reference arguments not supported by call_async"));
+    }
+  }
+  auto call = new(std::nothrow) AsyncCall{
+    nullptr, std::move(func), std::move(args), callback, env, std::move(trap)};
+  if (!call) {
+    Func::CallResult result{vec<Val>::invalid(),
+      Message::make_nt(std::string("out of memory"))};
+    callback(env, result);
+    return;
+  }
+  impl(store)->push_async(call);
+}
+
+void async_call_promise(void* env, Func::CallResult& result) {
+  auto promise = static_cast<std::promise<Func::CallResult>*>(env);
+  promise->set_value(std::move(result));
+  delete promise;
+}
+
+auto Func::call_async(Store* store, vec<Val>&& args) const
+-> std::future<CallResult> {
+  auto promise = new(std::nothrow) std::promise<CallResult>();
+  if (!promise) return std::future<CallResult>();
+  auto future = promise->get_future();
+  call_async(store, std::move(args), &async_call_promise, promise);
+  return future;
+}
+
+void Func::call_async(
+  Store* store, vec<Val>&& args, async_callback callback, void* env
+) const {
+  auto func = copy();
+  auto trap = Message::invalid();
+  if (func) {
+    // On the store's thread, so the signature can be checked right away.
+    auto sig = func_sig(impl(func.get()));
+    for (size_t i = 0; sig && i < sig->result_arity; ++i) {
+      if (!is_num(sig->result(i))) {
+        trap = Message::make_nt(
+          std::string("reference results not supported by call_async"));
+        break;
+      }
+    }
+  }
+  queue_async_call(std::move(func), store, std::move(args),
+    callback, env, std::move(trap));
+}
 
-  v8::TryCatch handler(isolate);
-  auto v8_function = v8::Local<v8::Function>::Cast(func->v8_object());
-  auto maybe_val = v8_function->Call(
-    context, v8::Undefined(isolate), param_types.size(), v8_args.get());
+auto Func::call_async(own<Func>&& func, Store* store, vec<Val>&& args)
+-> std::future<CallResult> {
+  auto promise = new(std::nothrow) std::promise<CallResult>();
+  if (!promise) return std::future<CallResult>();
+  auto future = promise->get_future();
+  call_async(std::move(func), store, std::move(args),
+    &async_call_promise, promise);
+  return future;
+}
+
+void Func::call_async(
+  own<Func>&& func, Store* store, vec<Val>&& args,
+  async_callback callback, void* env
+) {
+  queue_async_call(std::move(func), store, std::move(args),
+    callback, env, Message::invalid());
+}
 
-  if (handler.HasCaught()) {
-    auto exception = handler.Exception();
-    if (!exception->IsObject()) {
-      auto maybe_string = exception->ToString(store->context());
-      auto string = maybe_string.IsEmpty()
-        ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
-      exception = v8::Exception::Error(string);
+auto Func::call_unchecked(const Val args[], Val results[]) const -> own<Trap> {
+  auto func = impl(this);
+  StoreScope store_scope(func->isolate());
+  auto sig = func_sig(func);
+  if (!sig) return out_of_memory_trap(func->store());
+  return FuncCaller(func, sig).call(args, results);
+}
+
+auto Func::call_raw(uint64_t slots[]) const -> own<Trap> {
+  auto func = impl(this);
+  StoreScope store_scope(func->isolate());
+  auto sig = func_sig(func);
+  if (!sig) return out_of_memory_trap(func->store());
+  for (size_t i = 0; i < sig->param_arity; ++i) assert(is_num(sig->param(i)));
+  for (size_t i = 0; i < sig->result_arity; ++i) assert(is_num(sig->result(i)));
+  return FuncCaller(func, sig).call_raw(slots);
+}
+
+auto Func::prepare_raw() const -> RawTarget {
+  auto func = impl(this);
+  StoreScope store_scope(func->isolate());
+  auto sig = func_sig(func);
+  if (!sig || !sig->numeric) return RawTarget();
+  return FuncCaller(func, sig).raw_target();
+}
+
+auto Func::call_raw(const RawTarget& target, uint64_t slots[]) const
+-> own<Trap> {
+  auto func = impl(this);
+  StoreScope store_scope(func->isolate());
+  return FuncCaller(func, target).call_raw(slots);
+}
+
+auto Func::call_batch(
+  size_t n, const Val args[], Val results[], own<Trap>* first_trap
+) const -> size_t {
+  auto func = impl(this);
+  StoreScope store_scope(func->isolate());
+  auto sig = func_sig(func);
+  if (!sig) {
+    if (first_trap) *first_trap = out_of_memory_trap(func->store());
+    return 0;
+  }
+  FuncCaller caller(func, sig);
+  for (size_t i = 0; i < n; ++i) {
+    auto trap = caller.call(
+      args + i * sig->param_arity, results + i * sig->result_arity);
+    if (trap) {
+      if (first_trap) *first_trap = std::move(trap);
+      return i;
     }
-    return RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
   }
+  return n;
+}
 
-  auto val = maybe_val.ToLocalChecked();
-  if (result_types.size() == 0) {
-    assert(val->IsUndefined());
-  } else if (result_types.size() == 1) {
-    assert(!val->IsUndefined());
-    new (&results[0]) Val(v8_to_val(store, val, result_types[0].get()));
-  } else {
-    assert(val->IsArray());
-    auto array = v8::Handle<v8::Array>::Cast(val);
-    for (size_t i = 0; i < result_types.size(); ++i) {
-      auto maybe = array->Get(context, i);
-      assert(!maybe.IsEmpty());
-      new (&results[i]) Val(v8_to_val(
-        store, maybe.ToLocalChecked(), result_types[i].get()));
-    }
+namespace {
+
+// Column marshalling, specialized per kind so the loops can vectorize.
+
+template<class T>
+void encode_column(
+  uint64_t slots[], size_t stride, const T column[], size_t n
+) {
+  for (size_t i = 0; i < n; ++i) slots[i * stride] = raw_encode(column[i]);
+}
+
+template<class T>
+void decode_column(
+  T column[], const uint64_t slots[], size_t stride, size_t n
+) {
+  for (size_t i = 0; i < n; ++i) column[i] = raw_decode<T>(slots[i * stride]);
+}
+
+void encode_column(
+  uint64_t slots[], size_t stride, const Column& column, size_t start, size_t n
+) {
+  switch (column.kind) {
+    case ValKind::I32: return encode_column(
+      slots, stride, static_cast<const int32_t*>(column.data) + start, n);
+    case ValKind::I64: return encode_column(
+      slots, stride, static_cast<const int64_t*>(column.data) + start, n);
+    case ValKind::F32: return encode_column(
+      slots, stride, static_cast<const float32_t*>(column.data) + start, n);
+    case ValKind::F64: return encode_column(
+      slots, stride, static_cast<const float64_t*>(column.data) + start, n);
+    default: assert(false);
   }
-  return nullptr;
 }
 
-void FuncData::v8_callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
-  auto v8_data = v8::Local<v8::Object>::Cast(info.Data());
-  auto self = reinterpret_cast<FuncData*>(wasm_v8::foreign_get(v8_data));
-  auto store = impl(self->store);
-  auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+void decode_column(
+  const Column& column, size_t start, const uint64_t slots[], size_t stride, size_t n
+) {
+  switch (column.kind) {
+    case ValKind::I32: return decode_column(
+      static_cast<int32_t*>(column.data) + start, slots, stride, n);
+    case ValKind::I64: return decode_column(
+      static_cast<int64_t*>(column.data) + start, slots, stride, n);
+    case ValKind::F32: return decode_column(
+      static_cast<float32_t*>(column.data) + start, slots, stride, n);
+    case ValKind::F64: return decode_column(
+      static_cast<float64_t*>(column.data) + start, slots, stride, n);
+    default: assert(false);
+  }
+}
+
+}  // namespace
 
-  auto& param_types = self->type->params();
-  auto& result_types = self->type->results();
+auto Func::call_columns(
+  size_t n, const Column params[], const Column results[],
+  own<Trap>* first_trap
+) const -> size_t {
+  auto func = impl(this);
+  StoreScope store_scope(func->isolate());
+  auto sig = func_sig(func);
+  if (!sig) {
+    if (first_trap) *first_trap = out_of_memory_trap(func->store());
+    return 0;
+  }
+
+  bool match = sig->numeric;
+  for (size_t i = 0; i < sig->param_arity; ++i) {
+    match = match && params[i].kind == sig->param(i);
+  }
+  for (size_t i = 0; i < sig->result_arity; ++i) {
+    match = match && results[i].kind == sig->result(i);
+  }
+  if (!match) {
+    if (first_trap) {
+      auto message = Message::make_nt(
+        std::string("column kinds do not match function type"));
+      *first_trap = Trap::make(func->store(), message);
+    }
+    return 0;
+  }
 
-  assert(param_types.size() == info.Length());
+  // Transpose chunks of rows into slots, one call per row.
+  const size_t chunk_size = 256;
+  auto stride = std::max<size_t>(1, std::max(sig->param_arity, sig->result_arity));
+  auto chunk = std::unique_ptr<uint64_t[]>(
+    new(std::nothrow) uint64_t[stride * std::min(n, chunk_size)]);
+  if (!chunk) {
+    if (first_trap) *first_trap = out_of_memory_trap(func->store());
+    return 0;
+  }
+  FuncCaller caller(func, sig);
+  for (size_t start = 0; start < n; start += chunk_size) {
+    auto count = std::min(chunk_size, n - start);
+    for (size_t i = 0; i < sig->param_arity; ++i) {
+      encode_column(chunk.get() + i, stride, params[i], start, count);
+    }
+    for (size_t row = 0; row < count; ++row) {
+      auto trap = caller.call_raw(chunk.get() + row * stride);
+      if (trap) {
+        for (size_t i = 0; i < sig->result_arity; ++i) {
+          decode_column(results[i], start, chunk.get() + i, stride, row);
+        }
+        if (first_trap) *first_trap = std::move(trap);
+        return start + row;
+      }
+    }
+    for (size_t i = 0; i < sig->result_arity; ++i) {
+      decode_column(results[i], start, chunk.get() + i, stride, count);
+    }
+  }
+  return n;
+}
 
-  // TODO: cache params and result arrays per thread.
-  auto args = vec<Val>::make_uninitialized(param_types.size());
-  auto results = vec<Val>::make_uninitialized(result_types.size());
-  for (size_t i = 0; i < param_types.size(); ++i) {
-    args[i] = v8_to_val(store, info[i], param_types[i].get());
+auto FuncData::invoke(const Val args[], Val results[]) -> own<Trap> {
+  if (kind == CALLBACK_RAW) {
+    ScratchArray<uint64_t> slots(std::max(sig.param_arity, sig.result_arity));
+    if (!slots) return out_of_memory_trap(store);
+    for (size_t i = 0; i < sig.param_arity; ++i) {
+      slots[i] = val_to_raw(args[i]);
+    }
+    auto trap = callback_raw(env, slots.get());
+    if (trap) return trap;
+    for (size_t i = 0; i < sig.result_arity; ++i) {
+      results[i] = raw_to_val(slots[i], sig.result(i));
+    }
+    return nullptr;
   }
 
+  // Lend the argument and result arrays to the callback as vectors.
+  auto args_vec = vec<Val>::adopt(
+    sig.param_arity, sig.param_arity ? const_cast<Val*>(args) : nullptr);
+  auto results_vec = vec<Val>::adopt(
+    sig.result_arity, sig.result_arity ? results : nullptr);
   own<Trap> trap;
-  if (self->kind == CALLBACK_WITH_ENV) {
-    trap = self->callback_with_env(self->env, args, results);
+  if (kind == CALLBACK_WITH_ENV) {
+    trap = callback_with_env(env, args_vec, results_vec);
   } else {
-    trap = self->callback(args, results);
+    trap = callback(args_vec, results_vec);
   }
+  args_vec.release();
+  results_vec.release();
+  return trap;
+}
 
-  if (trap) {
-    isolate->ThrowException(impl(trap.get())->v8_object());
-    return;
-  }
+void FuncData::v8_callback(void* env, char* argv) {
+  auto self = static_cast<FuncData*>(env);
+  auto store = impl(self->store);
+  auto isolate = store->isolate();
+  StoreScope store_scope(isolate);
+  auto& sig = self->sig;
 
-  auto ret = info.GetReturnValue();
-  if (result_types.size() == 0) {
-    ret.SetUndefined();
-  } else if (result_types.size() == 1) {
-    assert(results[0].kind() == result_types[0]->kind());
-    ret.Set(val_to_v8(store, results[0]));
+  own<Trap> trap;
+  if (self->kind == CALLBACK_RAW) {
+    // Numeric slots widen and narrow in place.
+    ScratchArray<uint64_t> slots(std::max(sig.param_arity, sig.result_arity));
+    if (!slots) {
+      isolate->ThrowException(impl(out_of_memory_trap(store).get())->v8_object());
+      return;
+    }
+    auto p = argv;
+    for (size_t i = 0; i < sig.param_arity; ++i) {
+      auto size = wasm_v8::func_slot_size(
+        static_cast<wasm_v8::val_kind_t>(sig.param(i)));
+      slots[i] = 0;
+      std::memcpy(&slots[i], p, size);
+      p += size;
+    }
+    trap = self->callback_raw(self->env, slots.get());
+    if (!trap) {
+      p = argv;
+      for (size_t i = 0; i < sig.result_arity; ++i) {
+        auto size = wasm_v8::func_slot_size(
+          static_cast<wasm_v8::val_kind_t>(sig.result(i)));
+        std::memcpy(p, &slots[i], size);
+        p += size;
+      }
+    }
   } else {
-    auto context = store->context();
-    auto array = v8::Array::New(isolate, result_types.size());
-    for (size_t i = 0; i < result_types.size(); ++i) {
-      auto success = array->Set(context, i, val_to_v8(store, results[i]));
-      assert(success.IsJust() && success.ToChecked());
+    ScratchArray<Val> args(sig.param_arity);
+    ScratchArray<Val> results(sig.result_arity);
+    if (!args || !results) {
+      isolate->ThrowException(impl(out_of_memory_trap(store).get())->v8_object());
+      return;
+    }
+    auto p = argv;
+    for (size_t i = 0; i < sig.param_arity; ++i) {
+      args[i] = slot_to_val(store, p, sig.param(i));
+      p += wasm_v8::func_slot_size(
+        static_cast<wasm_v8::val_kind_t>(sig.param(i)));
+    }
+    trap = self->invoke(args.get(), results.get());
+    if (!trap) {
+      p = argv;
+      for (size_t i = 0; i < sig.result_arity; ++i) {
+        assert(is_ref(sig.result(i))
+          ? results[i].is_ref() : results[i].kind() == sig.result(i));
+        val_to_slot(store, p, sig.result(i), results[i]);
+        p += wasm_v8::func_slot_size(
+          static_cast<wasm_v8::val_kind_t>(sig.result(i)));
+      }
     }
-    ret.Set(array);
   }
+
+  if (trap) isolate->ThrowException(impl(trap.get())->v8_object());
 }
 
 void FuncData::finalize_func_data(void* data) {
@@ -1813,16 +3573,26 @@ auto Global::make(
 ) -> own<Global> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
   auto context = store->context();
 
   assert(type->content()->kind() == val.kind());
 
-  // Create wrapper instance
-  auto binary = wasm::bin::wrapper(type);
-  auto module = Module::make(store_abs, binary);
+  // Create wrapper instance, compiling the wrapper only once per type
+  auto key = static_cast<uint32_t>(type->content()->kind()) << 8 |
+    static_cast<uint32_t>(type->mutability());
+  auto& cached = store->wrapper_modules_[key];
+  if (cached.IsEmpty()) {
+    auto binary = wasm::bin::wrapper(type);
+    auto module = module_make(store, binary, false);
+    if (!module) return nullptr;
+    cached.Set(isolate, impl(module.get())->v8_object());
+    ++store->wrapper_misses_;
+  } else {
+    ++store->wrapper_hits_;
+  }
 
-  v8::Local<v8::Value> instantiate_args[] = { impl(module.get())->v8_object() };
+  v8::Local<v8::Value> instantiate_args[] = { cached.Get(isolate) };
   auto instance_obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
     context, 1, instantiate_args).ToLocalChecked();
   auto exports_obj = wasm_v8::instance_exports(instance_obj);
@@ -1838,7 +3608,7 @@ auto Global::make(
 
 auto Global::type() const -> own<GlobalType> {
   // return impl(this)->data->type->copy();
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto v8_global = impl(this)->v8_object();
   auto kind = static_cast<ValKind>(wasm_v8::global_type_content(v8_global));
   auto mutability = wasm_v8::global_type_mutable(v8_global)
@@ -1847,7 +3617,7 @@ auto Global::type() const -> own<GlobalType> {
 }
 
 auto Global::get() const -> Val {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto v8_global = impl(this)->v8_object();
   switch (type()->content()->kind()) {
     case ValKind::I32: return Val(wasm_v8::global_get_i32(v8_global));
@@ -1865,7 +3635,7 @@ auto Global::get() const -> Val {
 }
 
 void Global::set(const Val& val) {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto v8_global = impl(this)->v8_object();
   switch (val.kind()) {
     case ValKind::I32: return wasm_v8::global_set_i32(v8_global, val.i32());
@@ -1901,7 +3671,7 @@ auto Table::make(
 ) -> own<Table> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
   auto context = store->context();
 
   v8::Local<v8::Value> init = v8::Null(isolate);
@@ -1924,7 +3694,7 @@ auto Table::make(
 
 auto Table::type() const -> own<TableType> {
   // return impl(this)->data->type->copy();
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto v8_table = impl(this)->v8_object();
   uint32_t min = wasm_v8::table_type_min(v8_table);
   uint32_t max = wasm_v8::table_type_max(v8_table);
@@ -1933,7 +3703,7 @@ auto Table::type() const -> own<TableType> {
 }
 
 auto Table::get(size_t index) const -> own<Ref> {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto maybe = wasm_v8::table_get(impl(this)->v8_object(), index);
   if (maybe.IsEmpty()) return own<Ref>();
   auto obj = v8::Local<v8::Object>::Cast(maybe.ToLocalChecked());
@@ -1941,18 +3711,18 @@ auto Table::get(size_t index) const -> own<Ref> {
 }
 
 auto Table::set(size_t index, const Ref* ref) -> bool {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto val = ref_to_v8(impl(this)->store(), ref);
   return wasm_v8::table_set(impl(this)->v8_object(), index, val);
 }
 
 auto Table::size() const -> size_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return wasm_v8::table_size(impl(this)->v8_object());
 }
 
 auto Table::grow(size_t delta, const Ref* ref) -> bool {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto val = ref_to_v8(impl(this)->store(), ref);
   return wasm_v8::table_grow(impl(this)->v8_object(), delta, val);
 }
@@ -1974,7 +3744,7 @@ auto Memory::copy() const -> own<Memory> {
 auto Memory::make(Store* store_abs, const MemoryType* type) -> own<Memory> {
   auto store = impl(store_abs);
   auto isolate = store->isolate();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
   auto context = store->context();
 
   v8::Local<v8::Value> args[] = { memorytype_to_v8(store, type) };
@@ -1986,7 +3756,7 @@ auto Memory::make(Store* store_abs, const MemoryType* type) -> own<Memory> {
 
 auto Memory::type() const -> own<MemoryType> {
   // return impl(this)->data->type->copy();
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   auto v8_memory = impl(this)->v8_object();
   uint32_t min = wasm_v8::memory_type_min(v8_memory);
   uint32_t max = wasm_v8::memory_type_max(v8_memory);
@@ -1994,22 +3764,22 @@ auto Memory::type() const -> own<MemoryType> {
 }
 
 auto Memory::data() const -> byte_t* {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return wasm_v8::memory_data(impl(this)->v8_object());
 }
 
 auto Memory::data_size() const -> size_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return wasm_v8::memory_data_size(impl(this)->v8_object());
 }
 
 auto Memory::size() const -> pages_t {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return wasm_v8::memory_size(impl(this)->v8_object());
 }
 
 auto Memory::grow(pages_t delta) -> bool {
-  v8::HandleScope handle_scope(impl(this)->isolate());
+  StoreScope store_scope(impl(this)->isolate());
   return wasm_v8::memory_grow(impl(this)->v8_object(), delta);
 }
 
@@ -2027,6 +3797,22 @@ auto Instance::copy() const -> own<Instance> {
   return impl(this)->copy();
 }
 
+// Layout of the module's imports object, attached to the module, so that
+// instantiating allocates neither the object nor the import names.
+auto imports_layout(StoreImpl* store, v8::Local<v8::Object> module)
+-> v8::Local<v8::Array> {
+  auto context = store->context();
+  auto key = store->imports_layout_key();
+  auto maybe_value = module->GetPrivate(context, key);
+  if (!maybe_value.IsEmpty()) {
+    auto value = maybe_value.ToLocalChecked();
+    if (value->IsArray()) return v8::Local<v8::Array>::Cast(value);
+  }
+  auto layout = wasm_v8::instance_imports_layout(module);
+  ignore(module->SetPrivate(context, key, layout));
+  return layout;
+}
+
 auto Instance::make(
   Store* store_abs, const Module* module_abs, const vec<Extern*>& imports,
   own<Trap>* trap
@@ -2034,110 +3820,341 @@ auto Instance::make(
   auto store = impl(store_abs);
   auto module = impl(module_abs);
   auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(isolate);
 
   assert(wasm_v8::object_isolate(module->v8_object()) == isolate);
 
   if (trap) *trap = nullptr;
-  auto import_types = module_abs->imports();
-  auto imports_obj = v8::Object::New(isolate);
-  for (size_t i = 0; i < import_types.size(); ++i) {
-    auto type = import_types[i].get();
-    auto maybe_module = v8::String::NewFromOneByte(
-      isolate, reinterpret_cast<const uint8_t*>(type->module().get()),
-      v8::NewStringType::kNormal, type->module().size()
-    );
-    if (maybe_module.IsEmpty()) return own<Instance>();
-    auto module_str = maybe_module.ToLocalChecked();
-    auto maybe_name = v8::String::NewFromOneByte(
-      isolate, reinterpret_cast<const uint8_t*>(type->name().get()),
-      v8::NewStringType::kNormal, type->name().size()
-    );
-    if (maybe_name.IsEmpty()) return own<Instance>();
-    auto name_str = maybe_name.ToLocalChecked();
-
-    v8::Local<v8::Object> module_obj;
-    if (imports_obj->HasOwnProperty(context, module_str).ToChecked()) {
-      module_obj = v8::Local<v8::Object>::Cast(
-        imports_obj->Get(context, module_str).ToLocalChecked());
-    } else {
-      module_obj = v8::Object::New(isolate);
-      ignore(imports_obj->DefineOwnProperty(context, module_str, module_obj));
-    }
-
-    ignore(module_obj->DefineOwnProperty(
-      context, name_str, extern_to_v8(imports[i])));
+  auto data = module_data(store, module->v8_object());
+  if (!data) return own<Instance>();
+  ScratchArray<v8::Local<v8::Object>> v8_imports(data->imports.size());
+  if (!v8_imports) return own<Instance>();
+  for (size_t i = 0; i < data->imports.size(); ++i) {
+    v8_imports[i] = impl(imports[i])->v8_object();
   }
 
-  v8::TryCatch handler(isolate);
-  v8::Local<v8::Value> instantiate_args[] = {module->v8_object(), imports_obj};
-  auto obj = store->v8_function(V8_F_INSTANCE)->NewInstance(
-    context, 2, instantiate_args).ToLocalChecked();
-
-  if (handler.HasCaught() && trap) {
-    auto exception = handler.Exception();
-    if (!exception->IsObject()) {
-      auto maybe_string = exception->ToString(store->context());
-      auto string = maybe_string.IsEmpty()
-        ? store->v8_string(V8_S_EMPTY) : maybe_string.ToLocalChecked();
-      exception = v8::Exception::Error(string);
-    }
-    *trap = RefImpl<Trap>::make(store, v8::Local<v8::Object>::Cast(exception));
+  // V8 reads all imports before it runs the start function, so a nested
+  // instantiation of the same module cannot observe the shared layout.
+  auto layout = imports_layout(store, module->v8_object());
+  auto imports_obj = wasm_v8::instance_imports_fill(layout, v8_imports.get());
+  v8::Local<v8::Value> exception;
+  auto maybe_obj =
+    wasm_v8::instance_new(module->v8_object(), imports_obj, &exception);
+  wasm_v8::instance_imports_clear(layout);
+  if (maybe_obj.IsEmpty()) {
+    if (trap) *trap = exception_to_trap(store, exception);
     return nullptr;
   }
+  return RefImpl<Instance>::make(store, maybe_obj.ToLocalChecked());
+}
+
+// Cache of an instance's export objects, in module order, attached to the
+// instance. Slots are filled on first lookup, so that looking up a single
+// export does not cost time proportional to the number of exports.
+auto export_table(
+  StoreImpl* store, v8::Local<v8::Object> instance, const ModuleData* data
+) -> v8::Local<v8::Array> {
+  auto context = store->context();
+  auto key = store->export_table_key();
+  auto maybe_value = instance->GetPrivate(context, key);
+  if (!maybe_value.IsEmpty()) {
+    auto value = maybe_value.ToLocalChecked();
+    if (value->IsArray()) return v8::Local<v8::Array>::Cast(value);
+  }
+  auto table = v8::Array::New(store->isolate(), data->exports.size());
+  ignore(instance->SetPrivate(context, key, table));
+  return table;
+}
+
+auto export_object(
+  StoreImpl* store, v8::Local<v8::Object> instance, v8::Local<v8::Array> table,
+  const ModuleData* data, size_t i
+) -> v8::Local<v8::Object> {
+  auto context = store->context();
+  auto maybe_cached = table->Get(context, i);
+  if (maybe_cached.IsEmpty()) return v8::Local<v8::Object>();
+  auto cached = maybe_cached.ToLocalChecked();
+  if (cached->IsObject()) return v8::Local<v8::Object>::Cast(cached);
+
+  auto exports_obj = wasm_v8::instance_exports(instance);
+  assert(!exports_obj.IsEmpty() && exports_obj->IsObject());
+  auto& name = data->exports[i]->name();
+  auto maybe_name_obj = v8::String::NewFromUtf8(store->isolate(), name.get(),
+    v8::NewStringType::kInternalized, name.size());
+  if (maybe_name_obj.IsEmpty()) return v8::Local<v8::Object>();
+  auto maybe_obj = exports_obj->Get(context, maybe_name_obj.ToLocalChecked());
+  if (maybe_obj.IsEmpty()) return v8::Local<v8::Object>();
+  auto obj = v8::Local<v8::Object>::Cast(maybe_obj.ToLocalChecked());
+  ignore(table->Set(context, i, obj));
+  return obj;
+}
+
+auto export_to_extern(
+  StoreImpl* store, v8::Local<v8::Object> obj, ExternKind kind
+) -> own<Extern> {
+  if (obj.IsEmpty()) return own<Extern>();
+  switch (kind) {
+    case ExternKind::FUNC: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
+      return RefImpl<Func>::make(store, obj);
+    }
+    case ExternKind::GLOBAL: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
+      return RefImpl<Global>::make(store, obj);
+    }
+    case ExternKind::TABLE: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
+      return RefImpl<Table>::make(store, obj);
+    }
+    case ExternKind::MEMORY: {
+      assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
+      return RefImpl<Memory>::make(store, obj);
+    }
+  }
+  return own<Extern>();
+}
 
-  return RefImpl<Instance>::make(store, obj);
+// Looks up a single export, for export_by_name and export_by_index.
+auto instance_export(
+  StoreImpl* store, v8::Local<v8::Object> instance, const ModuleData* data,
+  size_t i
+) -> own<Extern> {
+  auto table = export_table(store, instance, data);
+  auto obj = export_object(store, instance, table, data, i);
+  return export_to_extern(store, obj, data->exports[i]->type()->kind());
 }
 
 auto Instance::exports() const -> ownvec<Extern> {
   auto instance = impl(this);
   auto store = instance->store();
-  auto isolate = store->isolate();
-  auto context = store->context();
-  v8::HandleScope handle_scope(isolate);
+  StoreScope store_scope(store->isolate());
 
   auto module_obj = wasm_v8::instance_module(instance->v8_object());
-  auto exports_obj = wasm_v8::instance_exports(instance->v8_object());
   assert(!module_obj.IsEmpty() && module_obj->IsObject());
-  assert(!exports_obj.IsEmpty() && exports_obj->IsObject());
+  auto data = module_data(store, module_obj);
+  if (!data) return ownvec<Extern>::invalid();
+  auto table = export_table(store, instance->v8_object(), data);
 
-  auto module = RefImpl<Module>::make(store, module_obj);
-  auto export_types = module->exports();
+  auto& export_types = data->exports;
   auto exports = ownvec<Extern>::make_uninitialized(export_types.size());
   if (!exports) return ownvec<Extern>::invalid();
-
   for (size_t i = 0; i < export_types.size(); ++i) {
-    auto& name = export_types[i]->name();
-    auto maybe_name_obj = v8::String::NewFromUtf8(isolate, name.get(),
-      v8::NewStringType::kNormal, name.size());
-    if (maybe_name_obj.IsEmpty()) return ownvec<Extern>::invalid();
-    auto name_obj = maybe_name_obj.ToLocalChecked();
-    auto obj = v8::Local<v8::Object>::Cast(
-      exports_obj->Get(context, name_obj).ToLocalChecked());
-
-    auto type = export_types[i]->type();
-    switch (type->kind()) {
-      case ExternKind::FUNC: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_FUNC);
-        exports[i] = RefImpl<Func>::make(store, obj);
-      } break;
-      case ExternKind::GLOBAL: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_GLOBAL);
-        exports[i] = RefImpl<Global>::make(store, obj);
-      } break;
-      case ExternKind::TABLE: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_TABLE);
-        exports[i] = RefImpl<Table>::make(store, obj);
-      } break;
-      case ExternKind::MEMORY: {
-        assert(wasm_v8::extern_kind(obj) == wasm_v8::EXTERN_MEMORY);
-        exports[i] = RefImpl<Memory>::make(store, obj);
-      } break;
+    auto obj = export_object(store, instance->v8_object(), table, data, i);
+    exports[i] = export_to_extern(store, obj, export_types[i]->type()->kind());
+  }
+  return exports;
+}
+
+auto Instance::export_by_name(const char* name, size_t size) const
+-> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  StoreScope store_scope(store->isolate());
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto data = module_data(store, module_obj);
+  if (!data) return own<Extern>();
+  auto it = data->export_indices.find(std::string_view(name, size));
+  if (it == data->export_indices.end()) return own<Extern>();
+  return instance_export(store, instance->v8_object(), data, it->second);
+}
+
+auto Instance::export_by_index(size_t i) const -> own<Extern> {
+  auto instance = impl(this);
+  auto store = instance->store();
+  StoreScope store_scope(store->isolate());
+  auto module_obj = wasm_v8::instance_module(instance->v8_object());
+  auto data = module_data(store, module_obj);
+  if (!data || i >= data->exports.size()) return own<Extern>();
+  return instance_export(store, instance->v8_object(), data, i);
+}
+
+// Linking
+
+auto valtypes_equal(
+  const ownvec<ValType>& types1, const ownvec<ValType>& types2
+) -> bool {
+  if (types1.size() != types2.size()) return false;
+  for (size_t i = 0; i < types1.size(); ++i) {
+    if (types1[i]->kind() != types2[i]->kind()) return false;
+  }
+  return true;
+}
+
+auto limits_match(const Limits& actual, const Limits& expected) -> bool {
+  return actual.min >= expected.min && actual.max <= expected.max;
+}
+
+auto extern_type_matches(
+  const ExternType* actual, const ExternType* expected
+) -> bool {
+  if (!actual || actual->kind() != expected->kind()) return false;
+  switch (actual->kind()) {
+    case ExternKind::FUNC: {
+      auto type1 = actual->func();
+      auto type2 = expected->func();
+      return valtypes_equal(type1->params(), type2->params()) &&
+        valtypes_equal(type1->results(), type2->results());
+    }
+    case ExternKind::GLOBAL: {
+      auto type1 = actual->global();
+      auto type2 = expected->global();
+      return type1->content()->kind() == type2->content()->kind() &&
+        type1->mutability() == type2->mutability();
+    }
+    case ExternKind::TABLE: {
+      auto type1 = actual->table();
+      auto type2 = expected->table();
+      return type1->element()->kind() == type2->element()->kind() &&
+        limits_match(type1->limits(), type2->limits());
+    }
+    case ExternKind::MEMORY: {
+      return limits_match(actual->memory()->limits(), expected->memory()->limits());
     }
   }
+  return false;
+}
 
-  return exports;
+struct LinkerImpl : Linker {
+  StoreImpl* store;
+  std::unordered_map<std::string, own<Extern>> defs;
+
+  explicit LinkerImpl(StoreImpl* store) : store(store) {
+    stats.make(Stats::LINKER, this);
+  }
+
+  ~LinkerImpl() {
+    stats.free(Stats::LINKER, this);
+  }
+
+  // Module names are length-prefixed, since names may contain any byte.
+  static auto key(const Name& module, const Name& name) -> std::string {
+    auto size = module.size();
+    std::string key(reinterpret_cast<const char*>(&size), sizeof(size));
+    key.append(module.get(), module.size());
+    key.append(name.get(), name.size());
+    return key;
+  }
+};
+
+template<> struct implement<Linker> { using type = LinkerImpl; };
+
+struct InstancePreImpl : InstancePre {
+  StoreImpl* store;
+  v8::Persistent<v8::Object> module;
+  v8::Persistent<v8::Object> imports;
+
+  InstancePreImpl(
+    StoreImpl* store, v8::Local<v8::Object> module, v8::Local<v8::Object> imports
+  ) : store(store),
+      module(store->isolate(), module),
+      imports(store->isolate(), imports) {
+    store->retain_handle();
+    stats.make(Stats::INSTANCEPRE, this);
+  }
+
+  ~InstancePreImpl() {
+    module.Reset();
+    imports.Reset();
+    store->release_handle();
+    stats.free(Stats::INSTANCEPRE, this);
+  }
+};
+
+template<> struct implement<InstancePre> { using type = InstancePreImpl; };
+
+
+void Linker::destroy() {
+  delete impl(this);
+}
+
+auto Linker::make(Store* store) -> own<Linker> {
+  return own<Linker>(new(std::nothrow) LinkerImpl(impl(store)));
+}
+
+auto Linker::define(const Name& module, const Name& name, const Extern* ex)
+-> bool {
+  auto linker = impl(this);
+  if (impl(ex)->store() != linker->store) return false;
+  auto copy = ex->copy();
+  if (!copy) return false;
+  linker->defs[LinkerImpl::key(module, name)] = std::move(copy);
+  return true;
+}
+
+auto Linker::resolve(const Module* module_abs, own<Trap>* trap) const
+-> own<InstancePre> {
+  auto linker = impl(this);
+  auto store = linker->store;
+  auto module = impl(module_abs);
+  StoreScope store_scope(store->isolate());
+
+  if (trap) *trap = nullptr;
+  auto fail = [&](const char* message) {
+    if (trap) *trap = Trap::make(store, Message::make_nt(std::string(message)));
+    return own<InstancePre>();
+  };
+  if (module->store() != store) return fail("module from another store");
+  auto data = module_data(store, module->v8_object());
+  if (!data) return fail("out of memory");
+  auto& import_types = data->imports;
+  ScratchArray<v8::Local<v8::Object>> v8_imports(import_types.size());
+  if (!v8_imports) return fail("out of memory");
+  for (size_t i = 0; i < import_types.size(); ++i) {
+    auto type = import_types[i].get();
+    auto it = linker->defs.find(LinkerImpl::key(type->module(), type->name()));
+    const char* error = nullptr;
+    if (it == linker->defs.end()) {
+      error = "unknown import ";
+    } else if (!extern_type_matches(it->second->type().get(), type->type())) {
+      error = "incompatible import type for ";
+    }
+    if (error) {
+      if (trap) {
+        auto message = std::string(error) +
+          std::string(type->module().get(), type->module().size()) + "." +
+          std::string(type->name().get(), type->name().size());
+        *trap = Trap::make(store, Message::make_nt(message));
+      }
+      return own<InstancePre>();
+    }
+    v8_imports[i] = impl(it->second.get())->v8_object();
+  }
+
+  auto imports_obj =
+    wasm_v8::instance_imports(module->v8_object(), v8_imports.get());
+  auto pre = new(std::nothrow)
+    InstancePreImpl(store, module->v8_object(), imports_obj);
+  if (!pre) return fail("out of memory");
+  return own<InstancePre>(pre);
+}
+
+auto Linker::instantiate(const Module* module, own<Trap>* trap) const
+-> own<Instance> {
+  auto pre = resolve(module, trap);
+  if (!pre) return own<Instance>();
+  return pre->instantiate(trap);
+}
+
+
+void InstancePre::destroy() {
+  delete impl(this);
+}
+
+auto InstancePre::instantiate(own<Trap>* trap) const -> own<Instance> {
+  auto pre = impl(this);
+  auto store = pre->store;
+  auto isolate = store->isolate();
+  StoreScope store_scope(isolate);
+
+  if (trap) *trap = nullptr;
+  v8::Local<v8::Value> exception;
+  auto maybe_obj = wasm_v8::instance_new(
+    pre->module.Get(isolate), pre->imports.Get(isolate), &exception);
+  if (maybe_obj.IsEmpty()) {
+    if (trap) *trap = exception_to_trap(store, exception);
+    return nullptr;
+  }
+  return RefImpl<Instance>::make(store, maybe_obj.ToLocalChecked());
 }
 
 ///////////////////////////////////////////////////////////////////////////////